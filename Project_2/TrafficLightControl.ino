@@ -1,3 +1,5 @@
+#include <FastPin.hpp>
+
 volatile bool buttonPressed = false;
 volatile unsigned long lastInterruptTime = 0;
 const unsigned long debounceDelay = 200; // milliseconds
@@ -46,10 +48,31 @@ const unsigned long changeState2To3Time = 3000;
 const unsigned long changeState3To4Time = 8000;
 const unsigned long changeState4To1Time = 4000;
 
+// 7-segment counter, pattern bits in A..G order
+typedef FastPinGroup<COUNTER_A_PIN, COUNTER_B_PIN, COUNTER_C_PIN, COUNTER_D_PIN,
+                     COUNTER_E_PIN, COUNTER_F_PIN, COUNTER_G_PIN> CounterSegments;
+
+const FastPortImage counterImages[] = {
+  CounterSegments::image(0b0000000), // 0 (blank)
+  CounterSegments::image(0b0000110), // 1
+  CounterSegments::image(0b1011011), // 2
+  CounterSegments::image(0b1001111), // 3
+  CounterSegments::image(0b1100110), // 4
+  CounterSegments::image(0b1101101), // 5
+  CounterSegments::image(0b1111101), // 6
+  CounterSegments::image(0b0000111), // 7
+  CounterSegments::image(0b1111111), // 8
+  CounterSegments::image(0b1101111)  // 9
+};
+
 unsigned long numberToDisplay = 0;
 
 bool countdownDelay = false;
 
+// Function prototypes
+void displayNumbers(unsigned long numberToDisplay);
+void handleInterrupt();
+
 void setup() {
   pinMode(BUTTON_PIN, INPUT_PULLUP);
   pinMode(BUZZER_PIN, OUTPUT);
@@ -75,12 +98,12 @@ void loop() {
 
   switch (trafficState) {
     case 1:
-      digitalWrite(CAR_GREEN_PIN, HIGH);
-      digitalWrite(CAR_RED_PIN, LOW);
-      digitalWrite(CAR_YELLOW_PIN , LOW);
+      FastPin<CAR_GREEN_PIN>::high();
+      FastPin<CAR_RED_PIN>::low();
+      FastPin<CAR_YELLOW_PIN>::low();
 
-      digitalWrite(PEDESTRIAN_RED_PIN, HIGH);
-      digitalWrite(PEDESTRIAN_GREEN_PIN, LOW);
+      FastPin<PEDESTRIAN_RED_PIN>::high();
+      FastPin<PEDESTRIAN_GREEN_PIN>::low();
 
       if (buttonPressed == true && countdownDelay == false) {
         stateStartTime = millis();
@@ -101,19 +124,19 @@ void loop() {
           lightFlashState = !lightFlashState;
           currentFlashTime = millis();
         }
-        digitalWrite(COUNTER_G_PIN, lightFlashState);
+        FastPin<COUNTER_G_PIN>::write(lightFlashState);
 
       }
       break;
 
     case 2:
 
-      digitalWrite(PEDESTRIAN_GREEN_PIN, LOW);
-      digitalWrite(PEDESTRIAN_RED_PIN, HIGH);
+      FastPin<PEDESTRIAN_GREEN_PIN>::low();
+      FastPin<PEDESTRIAN_RED_PIN>::high();
 
-      digitalWrite(CAR_YELLOW_PIN, HIGH);
-      digitalWrite(CAR_GREEN_PIN, LOW);
-      digitalWrite(CAR_RED_PIN, LOW);
+      FastPin<CAR_YELLOW_PIN>::high();
+      FastPin<CAR_GREEN_PIN>::low();
+      FastPin<CAR_RED_PIN>::low();
 
       if (millis() - stateStartTime > changeState2To3Time) {
         trafficState = 3;
@@ -127,12 +150,12 @@ void loop() {
 
     case 3:
 
-      digitalWrite(PEDESTRIAN_GREEN_PIN, HIGH);
-      digitalWrite(PEDESTRIAN_RED_PIN, LOW);
+      FastPin<PEDESTRIAN_GREEN_PIN>::high();
+      FastPin<PEDESTRIAN_RED_PIN>::low();
 
-      digitalWrite(CAR_RED_PIN, HIGH);
-      digitalWrite(CAR_YELLOW_PIN, LOW);
-      digitalWrite(CAR_GREEN_PIN, LOW);
+      FastPin<CAR_RED_PIN>::high();
+      FastPin<CAR_YELLOW_PIN>::low();
+      FastPin<CAR_GREEN_PIN>::low();
 
       numberToDisplay = (changeState3To4Time -  (millis() - stateStartTime)) / millisInASecond;
       displayNumbers(numberToDisplay);
@@ -164,12 +187,12 @@ void loop() {
         currentFlashTime = millis();
       }
 
-      digitalWrite(CAR_RED_PIN, HIGH);
-      digitalWrite(PEDESTRIAN_GREEN_PIN, lightFlashState);
+      FastPin<CAR_RED_PIN>::high();
+      FastPin<PEDESTRIAN_GREEN_PIN>::write(lightFlashState);
 
-      digitalWrite(CAR_GREEN_PIN, LOW);
-      digitalWrite(CAR_YELLOW_PIN, LOW);
-      digitalWrite(PEDESTRIAN_RED_PIN, LOW);
+      FastPin<CAR_GREEN_PIN>::low();
+      FastPin<CAR_YELLOW_PIN>::low();
+      FastPin<PEDESTRIAN_RED_PIN>::low();
 
       if ( millis() - currentBuzzTime > buzzerWarningPeriod) {
         buzzerState = !buzzerState;
@@ -193,109 +216,12 @@ void loop() {
 }
 
 void displayNumbers(unsigned long numberToDisplay) {
-  switch (numberToDisplay) {
-    case 0:
-      digitalWrite(COUNTER_A_PIN, LOW);
-      digitalWrite(COUNTER_B_PIN, LOW);
-      digitalWrite(COUNTER_C_PIN, LOW);
-      digitalWrite(COUNTER_D_PIN, LOW);
-      digitalWrite(COUNTER_E_PIN, LOW);
-      digitalWrite(COUNTER_F_PIN, LOW);
-      digitalWrite(COUNTER_G_PIN, LOW);
-      break;
-
-    case 1:
-      digitalWrite(COUNTER_A_PIN, LOW);
-      digitalWrite(COUNTER_B_PIN, HIGH);
-      digitalWrite(COUNTER_C_PIN, HIGH);
-      digitalWrite(COUNTER_D_PIN, LOW);
-      digitalWrite(COUNTER_E_PIN, LOW);
-      digitalWrite(COUNTER_F_PIN, LOW);
-      digitalWrite(COUNTER_G_PIN, LOW);
-      break;
-
-    case 2:
-      digitalWrite(COUNTER_A_PIN, HIGH);
-      digitalWrite(COUNTER_B_PIN, HIGH);
-      digitalWrite(COUNTER_C_PIN, LOW);
-      digitalWrite(COUNTER_D_PIN, HIGH);
-      digitalWrite(COUNTER_E_PIN, HIGH);
-      digitalWrite(COUNTER_F_PIN, LOW);
-      digitalWrite(COUNTER_G_PIN, HIGH);
-      break;
-
-
-    case 3:
-      digitalWrite(COUNTER_A_PIN, HIGH);
-      digitalWrite(COUNTER_B_PIN, HIGH);
-      digitalWrite(COUNTER_C_PIN, HIGH);
-      digitalWrite(COUNTER_D_PIN, HIGH);
-      digitalWrite(COUNTER_E_PIN, LOW);
-      digitalWrite(COUNTER_F_PIN, LOW);
-      digitalWrite(COUNTER_G_PIN, HIGH);
-      break;
-
-    case 4:
-      digitalWrite(COUNTER_A_PIN, LOW);
-      digitalWrite(COUNTER_B_PIN, HIGH);
-      digitalWrite(COUNTER_C_PIN, HIGH);
-      digitalWrite(COUNTER_D_PIN, LOW);
-      digitalWrite(COUNTER_E_PIN, LOW);
-      digitalWrite(COUNTER_F_PIN, HIGH);
-      digitalWrite(COUNTER_G_PIN, HIGH);
-      break;
-
-    case 5:
-      digitalWrite(COUNTER_A_PIN, HIGH);
-      digitalWrite(COUNTER_B_PIN, LOW);
-      digitalWrite(COUNTER_C_PIN, HIGH);
-      digitalWrite(COUNTER_D_PIN, HIGH);
-      digitalWrite(COUNTER_E_PIN, LOW);
-      digitalWrite(COUNTER_F_PIN, HIGH);
-      digitalWrite(COUNTER_G_PIN, HIGH);
-      break;
-
-    case 6:
-      digitalWrite(COUNTER_A_PIN, HIGH);
-      digitalWrite(COUNTER_B_PIN, LOW);
-      digitalWrite(COUNTER_C_PIN, HIGH);
-      digitalWrite(COUNTER_D_PIN, HIGH);
-      digitalWrite(COUNTER_E_PIN, HIGH);
-      digitalWrite(COUNTER_F_PIN, HIGH);
-      digitalWrite(COUNTER_G_PIN, HIGH);
-      break;
-
-    case 7:
-      digitalWrite(COUNTER_A_PIN, HIGH);
-      digitalWrite(COUNTER_B_PIN, HIGH);
-      digitalWrite(COUNTER_C_PIN, HIGH);
-      digitalWrite(COUNTER_D_PIN, LOW);
-      digitalWrite(COUNTER_E_PIN, LOW);
-      digitalWrite(COUNTER_F_PIN, LOW);
-      digitalWrite(COUNTER_G_PIN, LOW);
-      break;
-
-    case 8:
-      digitalWrite(COUNTER_A_PIN, HIGH);
-      digitalWrite(COUNTER_B_PIN, HIGH);
-      digitalWrite(COUNTER_C_PIN, HIGH);
-      digitalWrite(COUNTER_D_PIN, HIGH);
-      digitalWrite(COUNTER_E_PIN, HIGH);
-      digitalWrite(COUNTER_F_PIN, HIGH);
-      digitalWrite(COUNTER_G_PIN, HIGH);
-      break;
-
-    case 9:
-      digitalWrite(COUNTER_A_PIN, HIGH);
-      digitalWrite(COUNTER_B_PIN, HIGH);
-      digitalWrite(COUNTER_C_PIN, HIGH);
-      digitalWrite(COUNTER_D_PIN, HIGH);
-      digitalWrite(COUNTER_E_PIN, LOW);
-      digitalWrite(COUNTER_F_PIN, HIGH);
-      digitalWrite(COUNTER_G_PIN, HIGH);
-      break;
+  if (numberToDisplay > 9) {
+    return;
   }
 
+  // both ports of the display are updated with a single store each
+  CounterSegments::write(counterImages[numberToDisplay]);
 }
 
 void handleInterrupt() {
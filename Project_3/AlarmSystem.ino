@@ -4,22 +4,30 @@
    This alarm system operates as a state machine with serial menu-based control.
 
    SYSTEM STATES:
+   - CALIBRATING: Startup baseline measurement, at most 3 seconds
    - DISARMED: Default state, green LED on, sensors inactive
+   - SELF_TEST: 5-second alarm test started from the menu
    - ARMING: 3-second countdown transition state
    - ARMED: Sensors active, green LED pulses briefly every second
+   - PRE_ALARM: 3-second countdown after an intrusion, password cancels it
    - ALARM_TRIGGERED: Red LED flashing, buzzer sounding, awaiting password
 
    CORE FUNCTIONALITY:
-   1. Startup Calibration: System measures baseline distance over 3 seconds to establish
-      normal environment state for ultrasonic sensor
+   1. Startup Calibration: System takes the median of the first distance samples as
+      the normal environment state for ultrasonic sensor. It gives up after a capped
+      number of pings or 3 seconds and keeps whatever samples it got
 
    2. Arming Methods:
       - Manual: User selects "Arm System" from menu, 3-second countdown begins
       - Automatic: LDR detects light level below threshold (night mode)
 
    3. Intrusion Detection (when armed):
-      - Ultrasonic sensor continuously monitors distance changes
-      - If distance change exceeds sensitivity threshold, alarm triggers after 3-second delay
+      - Every ping goes through DistanceFilter: a rolling median drops bad echoes, the
+        baseline slowly follows drift while nothing moves, and motion is reported once
+        the deviation from the baseline stays above the sensitivity for a few pings
+      - The baseline is retaken when arming completes
+      - Motion while armed triggers the alarm after a 3-second countdown, which the
+        correct password cancels
 
    4. Alarm Response:
       - Red LED flashes at 500ms intervals
@@ -36,14 +44,22 @@
    TIMING ARCHITECTURE:
    - Uses millis() exclusively for non-blocking timing
    - Independent timers for LED flashing, sensor polling, and state transitions
-   - No delay() calls in main loop to maintain responsiveness
+   - No delay() calls anywhere: countdowns, the self-test and calibration are states
+     of their own, and the longest loop() pass is measured and shown in the menu
+   - Ultrasonic pings run in the background: a pin change interrupt times the echo
+     and loop() only picks up the latest finished distance
 
    INPUT HANDLING:
-   - Serial input buffered character-by-character until newline
+   - Serial input buffered character-by-character until newline, in a fixed-size
+     line buffer (longer lines are dropped)
    - Input context determined by current state and menu level
-   - Password verification and setting changes handled through state flags
+   - Menu choices are looked up in a command table kept in flash; a setting's value
+     can follow its choice ("1 15") or come on the next line when prompted
+   - No dynamic allocation anywhere: free RAM is shown in the main menu and stays put
 */
 
+#include <DistanceFilter.hpp>
+
 // Pin definitions
 const int PHOTOSENSOR_PIN = A0;
 const int TRIGGER_PIN = 5;
@@ -53,16 +69,20 @@ const int RED_LED_PIN = 11;
 const int GREEN_LED_PIN = 12;
 
 // System configuration
-String systemName = "Alarm :P";
-String password = "0000";
+const int passwordLength = 4;
+char systemName[17] = "Alarm :P";
+char password[passwordLength + 1] = "0000";
 int ultrasonicSensitivity = 10; // cm tolerance
 int ldrThreshold = 300; // Light threshold for auto-arm
 int buzzerFrequency = 2000; // Hz
-const int passwordLength = 4;
 
 // Timing constants
 const unsigned long armingDelay = 3000;
 const unsigned long alarmTriggerDelay = 3000;
+const unsigned long preAlarmFlashPeriod = 250;
+const unsigned long selfTestDuration = 5000;
+const unsigned long calibrationTimeout = 3000;
+const int calibrationPings = 30; // Retry cap, valid or not
 const unsigned long flashPeriod = 500;
 const unsigned long armedFlashOnTime = 100;
 const unsigned long armedFlashPeriod = 1000;
@@ -71,43 +91,164 @@ const float speedOfSound = 0.034; // cm per microsecond
 
 // System states
 enum SystemState {
+  STATE_CALIBRATING,
   STATE_DISARMED,
+  STATE_SELF_TEST,
   STATE_ARMING,
   STATE_ARMED,
+  STATE_PRE_ALARM,
   STATE_ALARM_TRIGGERED,
   STATE_SETTINGS_MENU
 };
 
-enum SettingsOption {
-  SETTING_ULTRASONIC,
-  SETTING_LDR,
-  SETTING_BUZZER,
-  SETTING_SYSTEM_NAME,
-  SETTING_PASSWORD,
-  SETTING_BACK
-};
-
 // Global variables
-SystemState currentState = STATE_DISARMED;
-SettingsOption currentSetting = SETTING_ULTRASONIC;
+SystemState currentState = STATE_CALIBRATING;
 bool inSettingsMenu = false;
-bool waitingForPasswordChange = false;
-bool verifyingOldPassword = false;
-String inputBuffer = "";
-String tempPassword = "";
+
+// Serial input: one line at a time in a fixed buffer, no String anywhere
+const byte inputLineSize = 32;
+char inputLine[inputLineSize];
+byte inputLength = 0;
+bool inputOverflow = false; // Line longer than the buffer, dropped at its end
 
 int baselineDistance = 0;
 int currentDistance = 0;
 int lightLevel = 0;
 
-unsigned long echoPinTimeout = 30000;
+// Ultrasonic ranging: a trigger pulse starts a ping, the echo pin's pin change
+// interrupt timestamps both edges, and loop() only collects finished results
+enum RangingState {
+  RANGING_IDLE,
+  RANGING_WAIT_ECHO,  // Triggered, echo not up yet
+  RANGING_ECHO_HIGH,  // Echo up, timing the round trip
+  RANGING_DONE        // Width ready for loop()
+};
+
+const unsigned long echoPinTimeout = 30000; // us from the trigger, longer means no echo
+const unsigned long rangingInterval = 60;   // ms between pings, lets the last echo die out
+static_assert(ECHO_PIN < 8, "the echo pin must be on port D (PCINT2_vect)");
+
+volatile byte rangingState = RANGING_IDLE;
+volatile unsigned long echoStartMicros = 0;
+volatile unsigned long echoWidthMicros = 0;
+unsigned long pingStartMicros = 0;
+unsigned long lastPingTime = 0;
+int latestDistance = 0;     // cm, 0 = no echo
+bool distanceReady = false; // latestDistance not taken yet
 
 unsigned long stateChangeTime = 0;
 unsigned long lastFlashTime = 0;
-unsigned long lastSensorCheckTime = 0;
 bool ledState = false;
 bool isFlashing = false;
 
+// Intrusion detection: median of 7 pings, 4 suspicious pings in a row to
+// confirm, and a baseline that moves 1/128 of the way per quiet ping (about
+// 8 s at one ping every 60 ms). bench/host/DistanceReplay.cpp replays traces
+// through the same settings.
+const DistanceFilterConfig distanceFilterConfig = {10, 4, 1, 7, 500};
+DistanceFilter<7> distanceFilter(distanceFilterConfig);
+
+// Calibration progress
+int calibrationValid = 0;
+int calibrationTries = 0;
+
+// Longest loop() pass since startup
+unsigned long maxLoopMicros = 0;
+
+// Menu being printed, a line per loop() pass and only when the line fits in
+// the serial TX buffer, so loop() never waits for the wire
+enum MenuLine {
+  LINE_HEADER,
+  LINE_STATUS,
+  LINE_COMMANDS,
+  LINE_LOOP_TIME,
+  LINE_FREE_RAM,
+  LINE_FOOTER,
+  LINE_PROMPT,
+  LINE_DONE
+};
+const int MENU_LINE_ROOM = 40; // Longest menu line, with the line break
+byte printedMenu = 0;
+byte menuLine = LINE_DONE;
+byte menuCommandIndex = 0;
+
+// Function prototypes
+void startCalibration();
+void handleCalibratingState();
+void finishCalibration();
+void setupRanging();
+void startPing();
+void updateRanging();
+bool takeDistance(int &distance);
+void checkLDRAutoArm();
+void handleArmingState();
+void handleArmedState();
+void handleSelfTestState();
+void handlePreAlarmState();
+void handleAlarmTriggeredState();
+void flashAlarm();
+void checkSensors();
+void triggerAlarm();
+void armSystem();
+void disarmSystem();
+void testAlarm();
+void showMainMenu();
+void showSettingsMenu();
+void printMenuLine();
+byte currentMenu();
+int freeRam();
+void handleSerialInput();
+void processInput(char *line);
+
+// Menu commands, looked up in a table in flash. Each gets the rest of its
+// line as argument, or nullptr when nothing followed the choice.
+typedef void (*CommandAction)(char *argument);
+
+bool needArgument(char *argument, CommandAction command);
+bool parseNumber(const char *text, int &value);
+bool isNumeric(const char *text);
+void commandArm(char *argument);
+void commandTest(char *argument);
+void commandSettings(char *argument);
+void commandDisarm(char *argument);
+void commandSensitivity(char *argument);
+void commandLightThreshold(char *argument);
+void commandBuzzerFrequency(char *argument);
+void commandSystemName(char *argument);
+void commandChangePassword(char *argument);
+void commandNewPassword(char *argument);
+void commandBack(char *argument);
+
+enum Menu {
+  MENU_MAIN,
+  MENU_ARMED,
+  MENU_SETTINGS
+};
+
+struct MenuCommand {
+  byte menu;
+  char key[2];
+  char label[34];
+  CommandAction action;
+};
+
+const MenuCommand menuCommands[] PROGMEM = {
+  {MENU_MAIN, "1", "Arm System", commandArm},
+  {MENU_MAIN, "2", "Test Alarm", commandTest},
+  {MENU_MAIN, "3", "Settings", commandSettings},
+  {MENU_ARMED, "1", "Disarm System (requires password)", commandDisarm},
+  {MENU_SETTINGS, "1", "Set Ultrasonic Sensitivity", commandSensitivity},
+  {MENU_SETTINGS, "2", "Set LDR Light Threshold", commandLightThreshold},
+  {MENU_SETTINGS, "3", "Set Buzzer Frequency", commandBuzzerFrequency},
+  {MENU_SETTINGS, "4", "Set System Name", commandSystemName},
+  {MENU_SETTINGS, "5", "Change Password", commandChangePassword},
+  {MENU_SETTINGS, "6", "Back to Main Menu", commandBack}
+};
+const byte menuCommandCount = sizeof(menuCommands) / sizeof(menuCommands[0]);
+
+// Command waiting for a value on the next line
+CommandAction pendingCommand = nullptr;
+
 void setup() {
   // Initialize pins
   pinMode(PHOTOSENSOR_PIN, INPUT);
@@ -116,8 +257,9 @@ void setup() {
   pinMode(BUZZER_PIN, OUTPUT);
   pinMode(RED_LED_PIN, OUTPUT);
   pinMode(GREEN_LED_PIN, OUTPUT);
+  setupRanging();
 
-  Serial.begin(9600);
+  Serial.begin(115200);
 
   // Startup message
   Serial.println(F("\n================================="));
@@ -126,33 +268,39 @@ void setup() {
   Serial.println(F("================================="));
   Serial.println(F("Calibrating sensors..."));
 
-  // Calibrate baseline distance
-  calibrateBaseline();
-
-  Serial.print(F("Baseline distance: "));
-  Serial.print(baselineDistance);
-  Serial.println(F(" cm"));
-  Serial.println(F("Calibration complete!\n"));
-
-  // Show initial status
-  digitalWrite(GREEN_LED_PIN, HIGH);
-  showMainMenu();
+  // Calibrate baseline distance, loop() takes it from here
+  startCalibration();
 }
 
 void loop() {
+  unsigned long loopStart = micros();
+
   handleSerialInput();
+  printMenuLine();
+  updateRanging();
+  if (currentState != STATE_CALIBRATING) {
+    checkSensors();
+  }
 
   // Check LDR for auto-arming
   checkLDRAutoArm();
 
   // Handle state-specific logic
   switch (currentState) {
+    case STATE_CALIBRATING:
+      handleCalibratingState();
+      break;
+
     case STATE_DISARMED:
       digitalWrite(GREEN_LED_PIN, HIGH);
       digitalWrite(RED_LED_PIN, LOW);
       noTone(BUZZER_PIN);
       break;
 
+    case STATE_SELF_TEST:
+      handleSelfTestState();
+      break;
+
     case STATE_ARMING:
       handleArmingState();
       break;
@@ -161,42 +309,134 @@ void loop() {
       handleArmedState();
       break;
 
+    case STATE_PRE_ALARM:
+      handlePreAlarmState();
+      break;
+
     case STATE_ALARM_TRIGGERED:
       handleAlarmTriggeredState();
       break;
   }
+
+  unsigned long loopTime = micros() - loopStart;
+  if (loopTime > maxLoopMicros) {
+    maxLoopMicros = loopTime;
+  }
 }
 
-void calibrateBaseline() {
-  long totalDistance = 0;
-  int validSamples = 0;
+void startCalibration() {
+  calibrationValid = 0;
+  calibrationTries = 0;
+  currentState = STATE_CALIBRATING;
+  stateChangeTime = millis();
+}
 
-  while (validSamples < distanceSamples) {
-    int dist = measureDistance();
+void handleCalibratingState() {
+  int dist;
+  if (takeDistance(dist)) {
+    calibrationTries++;
     if (dist > 0) { // Valid range
-      totalDistance += dist;
-      validSamples++;
+      calibrationValid++;
     }
+    distanceFilter.addSample(dist);
   }
 
-  baselineDistance = totalDistance / distanceSamples;
+  if (calibrationValid >= distanceSamples || calibrationTries >= calibrationPings ||
+      millis() - stateChangeTime >= calibrationTimeout) {
+    finishCalibration();
+  }
+}
+
+void finishCalibration() {
+  distanceFilter.rebase();
+  baselineDistance = distanceFilter.getBaseline();
+
+  if (baselineDistance < distanceFilterConfig.outOfRange) {
+    Serial.print(F("Baseline distance: "));
+    Serial.print(baselineDistance);
+    Serial.print(F(" cm ("));
+    Serial.print(calibrationValid);
+    Serial.println(F(" valid samples)"));
+  } else {
+    // Nothing in range: anything that shows up later counts as a change
+    Serial.println(F("No echo from the ultrasonic sensor, watching for anything coming into range."));
+  }
+  Serial.println(F("Calibration complete!\n"));
 
+  currentState = STATE_DISARMED;
+  digitalWrite(GREEN_LED_PIN, HIGH);
+  showMainMenu();
 }
 
-int measureDistance() {
+void setupRanging() {
   digitalWrite(TRIGGER_PIN, LOW);
-  delayMicroseconds(2);
+  *digitalPinToPCMSK(ECHO_PIN) |= _BV(digitalPinToPCMSKbit(ECHO_PIN));
+  PCIFR = _BV(digitalPinToPCICRbit(ECHO_PIN));
+  *digitalPinToPCICR(ECHO_PIN) |= _BV(digitalPinToPCICRbit(ECHO_PIN));
+}
+
+// Echo edges: both are timestamped here, everything else happens in loop()
+ISR(PCINT2_vect) {
+  unsigned long now = micros();
+  bool echoHigh = digitalRead(ECHO_PIN) == HIGH;
+
+  if (echoHigh && rangingState == RANGING_WAIT_ECHO) {
+    echoStartMicros = now;
+    rangingState = RANGING_ECHO_HIGH;
+  } else if (!echoHigh && rangingState == RANGING_ECHO_HIGH) {
+    echoWidthMicros = now - echoStartMicros;
+    rangingState = RANGING_DONE;
+  }
+}
+
+void startPing() {
+  rangingState = RANGING_WAIT_ECHO; // Idle, so the ISR isn't using it
+
+  // The 10 us trigger pulse is the only wait left
   digitalWrite(TRIGGER_PIN, HIGH);
   delayMicroseconds(10);
   digitalWrite(TRIGGER_PIN, LOW);
 
-  long duration = pulseIn(ECHO_PIN, HIGH); // 30ms timeout
-  
-  
+  pingStartMicros = micros();
+  lastPingTime = millis();
+}
+
+void updateRanging() {
+  noInterrupts();
+  byte state = rangingState;
+  unsigned long width = echoWidthMicros;
+  interrupts();
+
+  if (state == RANGING_DONE) {
+    latestDistance = width * speedOfSound / 2;
+    distanceReady = true;
+    rangingState = RANGING_IDLE;
+  } else if (state != RANGING_IDLE && micros() - pingStartMicros > echoPinTimeout) {
+    // No echo in time (nothing in range, or no sensor): 0, like pulseIn()
+    noInterrupts();
+    bool timedOut = (rangingState != RANGING_DONE);
+    if (timedOut) {
+      rangingState = RANGING_IDLE;
+    }
+    interrupts();
+
+    if (timedOut) {
+      latestDistance = 0;
+      distanceReady = true;
+    }
+  } else if (state == RANGING_IDLE && millis() - lastPingTime >= rangingInterval) {
+    startPing();
+  }
+}
 
-  int distance = duration * speedOfSound / 2;
-  return distance;
-  
+// The latest finished measurement, once
+bool takeDistance(int &distance) {
+  if (!distanceReady) {
+    return false;
+  }
+  distanceReady = false;
+  distance = latestDistance;
+  return true;
 }
 
 void checkLDRAutoArm() {
@@ -212,6 +452,7 @@ void checkLDRAutoArm() {
 void handleArmingState() {
   if (millis() - stateChangeTime >= armingDelay) {
     currentState = STATE_ARMED;
+    distanceFilter.rebase(); // The room as it is once the user has left
     Serial.println(F("[SYSTEM] Armed!"));
     digitalWrite(GREEN_LED_PIN, LOW);
   }
@@ -226,15 +467,44 @@ void handleArmedState() {
   } else if (currentTime - lastFlashTime >= armedFlashOnTime) {
     digitalWrite(RED_LED_PIN, LOW);
   }
+}
 
-  // Update sensor check time
-  if (currentTime - lastSensorCheckTime >= 200) {
-    lastSensorCheckTime = currentTime;
-    checkSensors();
+void handleSelfTestState() {
+  if (millis() - stateChangeTime >= selfTestDuration) {
+    digitalWrite(RED_LED_PIN, LOW);
+    noTone(BUZZER_PIN);
+    currentState = STATE_DISARMED;
+    Serial.println(F("[TEST MODE] Test complete."));
+    showMainMenu();
+    return;
+  }
+
+  flashAlarm();
+}
+
+void handlePreAlarmState() {
+  unsigned long currentTime = millis();
+  if (currentTime - stateChangeTime >= alarmTriggerDelay) {
+    currentState = STATE_ALARM_TRIGGERED;
+    lastFlashTime = currentTime;
+    Serial.println(F("\nAlarm sounding! Enter password to disarm:"));
+    return;
+  }
+
+  // Quick silent flashing while the countdown runs
+  if (currentTime - lastFlashTime >= preAlarmFlashPeriod) {
+    lastFlashTime = currentTime;
+    ledState = !ledState;
+    digitalWrite(RED_LED_PIN, ledState);
   }
 }
 
 void handleAlarmTriggeredState() {
+  flashAlarm();
+}
+
+// Red LED and buzzer together, flashPeriod on and off
+void flashAlarm() {
   unsigned long currentTime = millis();
 
   // Flash red LED
@@ -253,13 +523,13 @@ void handleAlarmTriggeredState() {
 }
 
 void checkSensors() {
-  // Check ultrasonic sensor
-  currentDistance = measureDistance();
-  if (currentDistance > 0) {
-    int distanceChange = abs(currentDistance - baselineDistance);
-    if (distanceChange > ultrasonicSensitivity) {
-      triggerAlarm();
-    }
+  // Every ping goes through the filter, disarmed too, so the baseline
+  // keeps up with drift
+  if (!takeDistance(currentDistance)) {
+    return;
+  }
+  if (distanceFilter.addSample(currentDistance) && currentState == STATE_ARMED) {
+    triggerAlarm();
   }
 }
 
@@ -267,11 +537,12 @@ void triggerAlarm() {
   if (currentState == STATE_ARMED) {
     Serial.println(F("\n!!! INTRUSION DETECTED !!!"));
     Serial.println(F("Alarm will sound in 3 seconds..."));
-    delay(alarmTriggerDelay); // Brief delay before alarm
-
-    currentState = STATE_ALARM_TRIGGERED;
-    lastFlashTime = millis();
     Serial.println(F("Enter password to disarm:"));
+
+    currentState = STATE_PRE_ALARM;
+    pendingCommand = nullptr; // Only the password counts now
+    stateChangeTime = millis();
+    lastFlashTime = stateChangeTime;
   }
 }
 
@@ -293,249 +564,392 @@ void disarmSystem() {
 
 void testAlarm() {
   Serial.println(F("\n[TEST MODE] Testing alarm for 5 seconds..."));
-  unsigned long testStart = millis();
-
-  while (millis() - testStart < 5000) {
-    unsigned long currentTime = millis();
-    if (currentTime - lastFlashTime >= flashPeriod) {
-      lastFlashTime = currentTime;
-      ledState = !ledState;
-      digitalWrite(RED_LED_PIN, ledState);
-      if (ledState) {
-        tone(BUZZER_PIN, buzzerFrequency);
+  currentState = STATE_SELF_TEST;
+  stateChangeTime = millis();
+  lastFlashTime = stateChangeTime;
+  ledState = false;
+}
+
+// Both menus are printed by printMenuLine() from the next loop() pass on
+void showMainMenu() {
+  printedMenu = (currentState == STATE_ARMED) ? MENU_ARMED : MENU_MAIN;
+  menuLine = LINE_HEADER;
+}
+
+void showSettingsMenu() {
+  printedMenu = MENU_SETTINGS;
+  menuLine = LINE_HEADER;
+}
+
+void printMenuLine() {
+  if (menuLine == LINE_DONE || Serial.availableForWrite() < MENU_LINE_ROOM) {
+    return;
+  }
+
+  bool settings = (printedMenu == MENU_SETTINGS);
+  switch (menuLine) {
+    case LINE_HEADER:
+      if (settings) {
+        Serial.println(F("\n========== SETTINGS =========="));
       } else {
-        noTone(BUZZER_PIN);
+        Serial.println(F("\n========== MAIN MENU =========="));
+      }
+      menuCommandIndex = 0;
+      menuLine = settings ? LINE_COMMANDS : LINE_STATUS;
+      break;
+
+    case LINE_STATUS:
+      if (printedMenu == MENU_ARMED) {
+        Serial.println(F("Status: ARMED"));
+      } else {
+        Serial.println(F("Status: DISARMED"));
+      }
+      menuLine = LINE_COMMANDS;
+      break;
+
+    case LINE_COMMANDS:
+      // One command per pass, in table order
+      while (menuCommandIndex < menuCommandCount &&
+             pgm_read_byte(&menuCommands[menuCommandIndex].menu) != printedMenu) {
+        menuCommandIndex++;
+      }
+      if (menuCommandIndex < menuCommandCount) {
+        Serial.print((const __FlashStringHelper *)menuCommands[menuCommandIndex].key);
+        Serial.print(F(". "));
+        Serial.println((const __FlashStringHelper *)menuCommands[menuCommandIndex].label);
+        menuCommandIndex++;
+      } else {
+        menuLine = settings ? LINE_FOOTER : LINE_LOOP_TIME;
+      }
+      break;
+
+    case LINE_LOOP_TIME:
+      Serial.print(F("Longest loop pass: "));
+      Serial.print(maxLoopMicros);
+      Serial.println(F(" us"));
+      menuLine = LINE_FREE_RAM;
+      break;
+
+    case LINE_FREE_RAM: {
+      int freeBytes = freeRam();
+      if (freeBytes >= 0) {
+        Serial.print(F("Free RAM: "));
+        Serial.print(freeBytes);
+        Serial.println(F(" bytes"));
       }
+      menuLine = LINE_FOOTER;
+      break;
     }
-  }
 
-  digitalWrite(RED_LED_PIN, LOW);
-  noTone(BUZZER_PIN);
-  Serial.println(F("[TEST MODE] Test complete."));
-  showMainMenu();
+    case LINE_FOOTER:
+      if (settings) {
+        Serial.println(F("=============================="));
+      } else {
+        Serial.println(F("==============================="));
+      }
+      menuLine = LINE_PROMPT;
+      break;
+
+    case LINE_PROMPT:
+      Serial.print(F("Enter choice: "));
+      menuLine = LINE_DONE;
+      break;
+  }
 }
 
-void showMainMenu() {
-  Serial.println(F("\n========== MAIN MENU =========="));
-  if (currentState == STATE_ARMED) {
-    Serial.println(F("Status: ARMED"));
-    Serial.println(F("1. Disarm System (requires password)"));
-  } else {
-    Serial.println(F("Status: DISARMED"));
-    Serial.println(F("1. Arm System"));
-    Serial.println(F("2. Test Alarm"));
-    Serial.println(F("3. Settings"));
+byte currentMenu() {
+  if (inSettingsMenu) {
+    return MENU_SETTINGS;
   }
-  Serial.println(F("==============================="));
-  Serial.print(F("Enter choice: "));
+  return currentState == STATE_ARMED ? MENU_ARMED : MENU_MAIN;
 }
 
-void showSettingsMenu() {
-  Serial.println(F("\n========== SETTINGS =========="));
-  Serial.println(F("1. Set Ultrasonic Sensitivity"));
-  Serial.println(F("2. Set LDR Light Threshold"));
-  Serial.println(F("3. Set Buzzer Frequency"));
-  Serial.println(F("4. Set System Name"));
-  Serial.println(F("5. Change Password"));
-  Serial.println(F("6. Back to Main Menu"));
-  Serial.println(F("=============================="));
-  Serial.print(F("Enter choice: "));
+// Gap between the top of the heap (never used, so its start) and the stack
+int freeRam() {
+#ifdef __AVR__
+  extern char __heap_start;
+  extern char *__brkval;
+  char top;
+  return &top - (__brkval != nullptr ? __brkval : &__heap_start);
+#else
+  return -1; // No AVR memory map in the host build
+#endif
 }
 
 void handleSerialInput() {
   while (Serial.available() > 0) {
     char incomingChar = Serial.read();
 
-    // Ignore newlines and carriage returns in buffer building
+    // A newline or carriage return ends the line
     if (incomingChar == '\n' || incomingChar == '\r') {
-      if (inputBuffer.length() > 0) {
-        processInput();
-        inputBuffer = "";
+      if (inputOverflow) {
+        Serial.println(F("\nInput too long, ignored."));
+      } else if (inputLength > 0) {
+        inputLine[inputLength] = '\0';
+        processInput(inputLine);
       }
+      inputLength = 0;
+      inputOverflow = false;
       continue;
     }
 
-    inputBuffer += incomingChar;
+    if (inputLength < inputLineSize - 1) {
+      inputLine[inputLength++] = incomingChar;
+    } else {
+      inputOverflow = true;
+    }
   }
 }
 
-void processInput() {
-  inputBuffer.trim();
+// Tokenizer: works in place, each token ends where its '\0' is written
+char *skipSpaces(char *text) {
+  while (*text == ' ' || *text == '\t') {
+    text++;
+  }
+  return text;
+}
 
-  if (inputBuffer.length() == 0) return;
+char *nextToken(char *&cursor) {
+  char *token = skipSpaces(cursor);
+  char *end = token;
+  while (*end != '\0' && *end != ' ' && *end != '\t') {
+    end++;
+  }
+  cursor = end;
+  if (*end != '\0') {
+    *end = '\0';
+    cursor = end + 1;
+  }
+  return token;
+}
 
-  Serial.println(inputBuffer); // Echo the input
+// The rest of the line without surrounding blanks, nullptr if nothing is left
+char *restOfLine(char *cursor) {
+  char *start = skipSpaces(cursor);
+  char *end = start + strlen(start);
+  while (end > start && (end[-1] == ' ' || end[-1] == '\t')) {
+    end--;
+  }
+  *end = '\0';
+  return *start != '\0' ? start : nullptr;
+}
 
-  // Handle password verification for password change
-  if (verifyingOldPassword) {
-    if (inputBuffer == password) {
-      Serial.println(F("Old password correct."));
-      Serial.print(F("Enter new password (4 digits): "));
-      verifyingOldPassword = false;
-      waitingForPasswordChange = true;
-    } else {
-      Serial.println(F("Incorrect password. Returning to settings."));
-      verifyingOldPassword = false;
-      showSettingsMenu();
-    }
-    inputBuffer = "";
+void processInput(char *line) {
+  line = restOfLine(line);
+  if (line == nullptr) return;
+
+  Serial.println(line); // Echo the input
+
+  // Nothing to choose until calibration is done or the test is over
+  if (currentState == STATE_CALIBRATING) {
+    Serial.println(F("Still calibrating, please wait."));
     return;
   }
-
-  // Handle new password entry
-  if (waitingForPasswordChange) {
-    if (inputBuffer.length() == passwordLength && isNumeric(inputBuffer)) {
-      password = inputBuffer;
-      Serial.println(F("Password changed successfully!"));
-    } else {
-      Serial.println(F("Invalid password. Must be 4 digits."));
-    }
-    waitingForPasswordChange = false;
-    showSettingsMenu();
-    inputBuffer = "";
+  if (currentState == STATE_SELF_TEST) {
+    Serial.println(F("Test in progress, please wait."));
     return;
   }
 
-  // Handle alarm triggered state (password entry)
-  if (currentState == STATE_ALARM_TRIGGERED) {
-    if (inputBuffer == password) {
+  // Handle countdown and alarm (password entry)
+  if (currentState == STATE_PRE_ALARM || currentState == STATE_ALARM_TRIGGERED) {
+    if (strcmp(line, password) == 0) {
       Serial.println(F("Correct password!"));
       disarmSystem();
     } else {
       Serial.println(F("Incorrect password! Try again:"));
     }
-    inputBuffer = "";
     return;
   }
 
-  // Handle settings menu
-  if (inSettingsMenu) {
-    handleSettingsInput(inputBuffer);
-    inputBuffer = "";
+  // A command that asked for a value gets the whole line
+  if (pendingCommand != nullptr) {
+    CommandAction action = pendingCommand;
+    pendingCommand = nullptr;
+    action(line);
     return;
   }
 
-  // Handle main menu
-  handleMainMenuInput(inputBuffer);
-  inputBuffer = "";
+  // "<choice> [value]", so a setting can be changed in one line
+  char *cursor = line;
+  char *choice = nextToken(cursor);
+  char *argument = restOfLine(cursor);
+  byte menu = currentMenu();
+
+  for (byte i = 0; i < menuCommandCount; i++) {
+    if (pgm_read_byte(&menuCommands[i].menu) == menu && strcmp_P(choice, menuCommands[i].key) == 0) {
+      CommandAction action = (CommandAction)pgm_read_ptr(&menuCommands[i].action);
+      action(argument);
+      return;
+    }
+  }
+
+  Serial.println(F("Invalid choice."));
+  if (menu == MENU_SETTINGS) {
+    showSettingsMenu();
+  } else {
+    showMainMenu();
+  }
 }
 
-void handleMainMenuInput(String input) {
-  if (currentState == STATE_ARMED) {
-    if (input == "1") {
-      Serial.print(F("Enter password: "));
-      // Next input will be handled as password in STATE_ARMED disarm attempt
-      // We need a flag for this
-      currentState = STATE_ALARM_TRIGGERED; // Reuse password checking
-      currentState = STATE_ARMED; // Keep armed until correct password
-      // Better: add specific state
-      Serial.print(F("Enter password to disarm: "));
-      // Simplified: just ask for password, next input checks it
+// Prompts for the value when it didn't come with the choice; the next line
+// goes back to the same command
+bool needArgument(char *argument, CommandAction command) {
+  if (argument != nullptr) {
+    return false;
+  }
+  pendingCommand = command;
+  return true;
+}
+
+// Up to 4 digits: every setting fits, and so does the Uno's 16-bit int
+bool parseNumber(const char *text, int &value) {
+  if (*text == '\0' || strlen(text) > 4 || !isNumeric(text)) {
+    return false;
+  }
+  value = atoi(text);
+  return true;
+}
+
+bool isNumeric(const char *text) {
+  for (; *text != '\0'; text++) {
+    if (!isDigit(*text)) {
+      return false;
     }
+  }
+  return true;
+}
+
+// Main menu
+void commandArm(char *) {
+  armSystem();
+}
+
+void commandTest(char *) {
+  testAlarm();
+}
+
+void commandSettings(char *) {
+  inSettingsMenu = true;
+  showSettingsMenu();
+}
+
+void commandDisarm(char *argument) {
+  if (needArgument(argument, commandDisarm)) {
+    Serial.print(F("Enter password to disarm: "));
+    return;
+  }
+
+  if (strcmp(argument, password) == 0) {
+    Serial.println(F("Correct password!"));
+    disarmSystem();
   } else {
-    if (input == "1") {
-      armSystem();
-    } else if (input == "2") {
-      testAlarm();
-    } else if (input == "3") {
-      inSettingsMenu = true;
-      showSettingsMenu();
-    } else {
-      Serial.println(F("Invalid choice."));
-      showMainMenu();
-    }
+    Serial.println(F("Incorrect password."));
+    showMainMenu();
   }
 }
 
-void handleSettingsInput(String input) {
-  int choice = input.toInt();
+// Settings menu
+void commandSensitivity(char *argument) {
+  if (needArgument(argument, commandSensitivity)) {
+    Serial.print(F("Enter ultrasonic sensitivity (cm, current: "));
+    Serial.print(ultrasonicSensitivity);
+    Serial.print(F("): "));
+    return;
+  }
 
-  switch (choice) {
-    case 1:
-      Serial.print(F("Enter ultrasonic sensitivity (cm, current: "));
-      Serial.print(ultrasonicSensitivity);
-      Serial.print(F("): "));
-      // Next input will be the value
-      currentSetting = SETTING_ULTRASONIC;
-      break;
+  int value;
+  if (parseNumber(argument, value) && value > 0 && value < 100) {
+    ultrasonicSensitivity = value;
+    distanceFilter.setSensitivity(value);
+    Serial.println(F("Ultrasonic sensitivity updated!"));
+  } else {
+    Serial.println(F("Invalid value."));
+  }
+  showSettingsMenu();
+}
 
-    case 2:
-      Serial.print(F("Enter LDR threshold (0-1023, current: "));
-      Serial.print(ldrThreshold);
-      Serial.print(F("): "));
-      currentSetting = SETTING_LDR;
-      break;
+void commandLightThreshold(char *argument) {
+  if (needArgument(argument, commandLightThreshold)) {
+    Serial.print(F("Enter LDR threshold (0-1023, current: "));
+    Serial.print(ldrThreshold);
+    Serial.print(F("): "));
+    return;
+  }
 
-    case 3:
-      Serial.print(F("Enter buzzer frequency (Hz, current: "));
-      Serial.print(buzzerFrequency);
-      Serial.print(F("): "));
-      currentSetting = SETTING_BUZZER;
-      break;
+  int value;
+  if (parseNumber(argument, value) && value >= 0 && value <= 1023) {
+    ldrThreshold = value;
+    Serial.println(F("LDR threshold updated!"));
+  } else {
+    Serial.println(F("Invalid value."));
+  }
+  showSettingsMenu();
+}
 
-    case 4:
-      Serial.print(F("Enter system name (current: "));
-      Serial.print(systemName);
-      Serial.print(F("): "));
-      currentSetting = SETTING_SYSTEM_NAME;
-      break;
+void commandBuzzerFrequency(char *argument) {
+  if (needArgument(argument, commandBuzzerFrequency)) {
+    Serial.print(F("Enter buzzer frequency (Hz, current: "));
+    Serial.print(buzzerFrequency);
+    Serial.print(F("): "));
+    return;
+  }
 
-    case 5:
-      Serial.print(F("Enter current password: "));
-      verifyingOldPassword = true;
-      break;
+  int value;
+  if (parseNumber(argument, value) && value >= 100 && value <= 5000) {
+    buzzerFrequency = value;
+    Serial.println(F("Buzzer frequency updated!"));
+  } else {
+    Serial.println(F("Invalid value. Use 100-5000 Hz."));
+  }
+  showSettingsMenu();
+}
 
-    case 6:
-      inSettingsMenu = false;
-      showMainMenu();
-      break;
+void commandSystemName(char *argument) {
+  if (needArgument(argument, commandSystemName)) {
+    Serial.print(F("Enter system name (current: "));
+    Serial.print(systemName);
+    Serial.print(F("): "));
+    return;
+  }
 
-    default:
-      // Check if we're receiving a setting value
-      if (currentSetting == SETTING_ULTRASONIC) {
-        int value = input.toInt();
-        if (value > 0 && value < 100) {
-          ultrasonicSensitivity = value;
-          Serial.println(F("Ultrasonic sensitivity updated!"));
-        } else {
-          Serial.println(F("Invalid value."));
-        }
-        showSettingsMenu();
-      } else if (currentSetting == SETTING_LDR) {
-        int value = input.toInt();
-        if (value >= 0 && value <= 1023) {
-          ldrThreshold = value;
-          Serial.println(F("LDR threshold updated!"));
-        } else {
-          Serial.println(F("Invalid value."));
-        }
-        showSettingsMenu();
-      } else if (currentSetting == SETTING_BUZZER) {
-        int value = input.toInt();
-        if (value >= 100 && value <= 5000) {
-          buzzerFrequency = value;
-          Serial.println(F("Buzzer frequency updated!"));
-        } else {
-          Serial.println(F("Invalid value. Use 100-5000 Hz."));
-        }
-        showSettingsMenu();
-      } else if (currentSetting == SETTING_SYSTEM_NAME) {
-        systemName = input;
-        Serial.println(F("System name updated!"));
-        showSettingsMenu();
-      } else {
-        Serial.println(F("Invalid choice."));
-        showSettingsMenu();
-      }
-      break;
+  if (strlen(argument) < sizeof(systemName)) {
+    strcpy(systemName, argument);
+    Serial.println(F("System name updated!"));
+  } else {
+    Serial.print(F("Name too long, "));
+    Serial.print(sizeof(systemName) - 1);
+    Serial.println(F(" characters at most."));
   }
+  showSettingsMenu();
 }
 
-bool isNumeric(String str) {
-  for (unsigned int i = 0; i < str.length(); i++) {
-    if (!isDigit(str.charAt(i))) {
-      return false;
-    }
+void commandChangePassword(char *argument) {
+  if (needArgument(argument, commandChangePassword)) {
+    Serial.print(F("Enter current password: "));
+    return;
   }
-  return true;
+
+  if (strcmp(argument, password) == 0) {
+    Serial.println(F("Old password correct."));
+    Serial.print(F("Enter new password (4 digits): "));
+    pendingCommand = commandNewPassword;
+  } else {
+    Serial.println(F("Incorrect password. Returning to settings."));
+    showSettingsMenu();
+  }
+}
+
+void commandNewPassword(char *argument) {
+  if (strlen(argument) == passwordLength && isNumeric(argument)) {
+    strcpy(password, argument);
+    Serial.println(F("Password changed successfully!"));
+  } else {
+    Serial.println(F("Invalid password. Must be 4 digits."));
+  }
+  showSettingsMenu();
+}
+
+void commandBack(char *) {
+  inSettingsMenu = false;
+  showMainMenu();
 }
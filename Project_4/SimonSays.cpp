@@ -5,6 +5,14 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <EEPROM.h>
+#include <FastPin.hpp>
+#include <ShiftDisplay.hpp>
+#include <PackedSequence.hpp>
+#include <StateMachine.hpp>
+#include <Xorshift.hpp>
+#include <DifficultyController.hpp>
+#include <GameRecords.hpp>
+#include <ToneQueue.hpp>
 
 // Pin definitions
 const int JOYSTICK_BUTTON_PIN = 2;
@@ -21,22 +29,41 @@ const int COPI_PIN = 11;        // MOSI pin (DS/SER) - hardware SPI
 const int SCK_PIN = 13;         // Clock pin (SHCP/SRCLK) - hardware SPI
 
 // Display configuration
+// The segment 74HC595 can be followed by digit-select 595s (8 digits each);
+// with none, the digits are selected through DIGIT1_PIN..DIGIT4_PIN as wired now
 const int displayDigitsNumber = 4;
+const int digitSelectRegisters = 0;
 int displayDigits[] = {DIGIT1_PIN, DIGIT2_PIN, DIGIT3_PIN, DIGIT4_PIN};
 const bool COMMON_CATHODE = true;  // Set based on your display type
 
+typedef ShiftDisplay<displayDigitsNumber, CS_PIN, digitSelectRegisters, COMMON_CATHODE> Display;
+typedef Display::Mask DigitMask;  // Bit per digit
+static_assert(Display::selectsDigits || displayDigitsNumber == 4,
+              "more than 4 digits needs digit-select shift registers");
+
+// Digit select images (common cathode: LOW = on), index 4 = all digits off
+typedef FastPinGroup<DIGIT1_PIN, DIGIT2_PIN, DIGIT3_PIN, DIGIT4_PIN> DigitSelect;
+const FastPortImage digitSelectImages[] = {
+  DigitSelect::image(0b1110), // Digit 1
+  DigitSelect::image(0b1101), // Digit 2
+  DigitSelect::image(0b1011), // Digit 3
+  DigitSelect::image(0b0111), // Digit 4
+  DigitSelect::image(0b1111)  // None
+};
+const int digitSelectOff = 4;
+
 // Character sets
 const int charSetSize = 19;
-const char charSet[] = {'A', 'b', 'c', 'd', 'E', 'F', 'G', 'H', 'I', 'J', 'L', 'n', 'O', 'P', 'r', 'S', 't', 'u', 'Y'};
+constexpr char charSet[] = {'A', 'b', 'c', 'd', 'E', 'F', 'G', 'H', 'I', 'J', 'L', 'n', 'O', 'P', 'r', 'S', 't', 'u', 'Y'};
 
 const int numberSetSize = 10;
-const char numberSet[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+constexpr char numberSet[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
 
 /**
  * Bit order for encoding:
  * DP, G, F, E, D, C, B, A
  */
-const byte charSegmentEncoding[] = {
+constexpr byte charSegmentEncoding[] = {
   0b01110111, // A
   0b01111100, // b
   0b01011000, // c
@@ -58,7 +85,7 @@ const byte charSegmentEncoding[] = {
   0b01101110  // Y
 };
 
-const byte numberSegmentEncoding[] = {
+constexpr byte numberSegmentEncoding[] = {
   0b00111111, // 0
   0b00000110, // 1
   0b01011011, // 2
@@ -71,31 +98,90 @@ const byte numberSegmentEncoding[] = {
   0b01101111  // 9
 };
 
+// ASCII lookup tables, generated at compile time from the sets above and kept
+// in flash, so a digit refresh is one table read instead of two linear scans
+const int asciiTableSize = 128;
+const byte asciiNotFound = 0xFF;
+const byte asciiNumberFlag = 0x80;  // Index table: set for numberSet entries
+
+constexpr int findInSet(const char* set, int size, char c, int i = 0) {
+  return (i >= size) ? -1 : ((set[i] == c) ? i : findInSet(set, size, c, i + 1));
+}
+
+constexpr byte segmentsForAscii(int c) {
+  return (findInSet(charSet, charSetSize, (char)c) >= 0) ?
+           charSegmentEncoding[findInSet(charSet, charSetSize, (char)c)] :
+         (findInSet(numberSet, numberSetSize, (char)c) >= 0) ?
+           numberSegmentEncoding[findInSet(numberSet, numberSetSize, (char)c)] :
+           0b00000000;
+}
+
+constexpr byte indexForAscii(int c) {
+  return (findInSet(charSet, charSetSize, (char)c) >= 0) ?
+           (byte)findInSet(charSet, charSetSize, (char)c) :
+         (findInSet(numberSet, numberSetSize, (char)c) >= 0) ?
+           (byte)(asciiNumberFlag | findInSet(numberSet, numberSetSize, (char)c)) :
+           asciiNotFound;
+}
+
+// A character in both sets would make the index table ambiguous
+constexpr bool setsDisjoint(int i = 0) {
+  return (i >= numberSetSize) ||
+         (findInSet(charSet, charSetSize, numberSet[i]) < 0 && setsDisjoint(i + 1));
+}
+static_assert(setsDisjoint(), "charSet and numberSet must not share characters");
+static_assert(sizeof(charSegmentEncoding) == charSetSize, "one encoding per charSet entry");
+static_assert(sizeof(numberSegmentEncoding) == numberSetSize, "one encoding per numberSet entry");
+
+#define ASCII_ROW(f, row) \
+  f(row + 0), f(row + 1), f(row + 2), f(row + 3), f(row + 4), f(row + 5), f(row + 6), f(row + 7), \
+  f(row + 8), f(row + 9), f(row + 10), f(row + 11), f(row + 12), f(row + 13), f(row + 14), f(row + 15)
+#define ASCII_TABLE(f) \
+  ASCII_ROW(f, 0), ASCII_ROW(f, 16), ASCII_ROW(f, 32), ASCII_ROW(f, 48), \
+  ASCII_ROW(f, 64), ASCII_ROW(f, 80), ASCII_ROW(f, 96), ASCII_ROW(f, 112)
+
+const byte asciiSegments[asciiTableSize] PROGMEM = { ASCII_TABLE(segmentsForAscii) };
+const byte asciiIndices[asciiTableSize] PROGMEM = { ASCII_TABLE(indexForAscii) };
+
+#undef ASCII_TABLE
+#undef ASCII_ROW
+
 // Text constants
 const char textPlay[] = "PLAY";
 const char textScore[] = "ScOr";
 const char textStop[] = "StOP";
 const char textPause[] = "PAuS";
 const char textError[] = "Err ";
+const char textCode[] = "cOdE";
+const char textProfile[] = "PLYr";
 
-// Game states
+// Game states (hooks and transitions are in the tables below the prototypes)
 enum gameState {
   STATE_MENU,
   STATE_SHOW_SEQUENCE,
   STATE_INPUT_PHASE,
-  STATE_CHECK_ANSWER,
-  STATE_RESULT,
+  STATE_ROUND_WON,
+  STATE_GAME_OVER,
   STATE_PAUSE,
   STATE_SHOW_SCORE,
-  STATE_SHOW_PAUSE_TEXT  // New state for displaying "PAuS"
+  STATE_SHOW_PAUSE_TEXT,
+  STATE_SHOW_CODE,
+  STATE_ENTER_CODE,
+  STATE_SELECT_PROFILE,
+  STATE_EDIT_INITIALS,
+  STATE_COUNT
 };
 
 // Menu items
 enum menuItem {
   MENU_PLAY,
   MENU_SCORE,
-  MENU_STOP
+  MENU_PROFILE,  // Main menu only
+  MENU_CODE,     // Main menu only
+  MENU_STOP,
+  MENU_ITEM_COUNT
 };
+const char* const menuTexts[] = {textPlay, textScore, textProfile, textCode, textStop};
 
 // Character type enum
 enum alphaOrNumber {
@@ -104,25 +190,57 @@ enum alphaOrNumber {
 };
 
 // Game state variables
-gameState currentState = STATE_MENU;
 menuItem currentMenuItem = MENU_PLAY;
 int currentRound = 0;
-int highScore = 0;
 
-// Game sequence and input
-char gameSequence[4];
-char playerInput[4];
+// Player records in EEPROM: profiles with initials, a top 5 per profile and
+// the last 16 games. The store starts where the single-byte high score was.
+const int recordsAddress = 100;
+const byte profileCount = 4;
+const byte topScoreCount = 5;
+const byte gameLogSize = 16;
+typedef GameRecords<profileCount, topScoreCount, gameLogSize> Records;
+Records records(recordsAddress);
+byte browsedProfile = 0;  // Shown in the profile menu
+
+// This game's totals for the log, written once when it ends
+bool gameUnsaved = false;
+unsigned long gameInputTime = 0;
+unsigned int gameSymbolsEntered = 0;
+
+// Game sequence: grows by one symbol per round, stored as 5-bit charSet
+// indices (320 bytes for 512 rounds)
+const int maxSequenceLength = 512;
+static_assert(charSetSize <= 32, "charSet indices must fit in 5 bits");
+PackedSequence<maxSequenceLength, 5> gameSequence;
+
+// Sequence generator: every game is seeded from a 4-digit challenge code,
+// which is shown before the first round and can be typed in under "cOdE" to
+// replay (or share) that exact game
+const int challengeCodeDigits = 4;
+const unsigned int challengeCodeCount = 10000;
+const int codeDisplayTime = 2000;
+static_assert(displayDigitsNumber >= challengeCodeDigits, "challenge code must fit on the display");
+Xorshift32 sequenceRandom;
+unsigned int challengeCode = 0;
+unsigned long entropyPool = 0;  // ADC noise, stirred on every joystick scan
+
+// Playback and input both go one page (displayDigitsNumber symbols) at a time
+int playbackPageStart = 0;
+bool playbackGap = false;  // Blank pause between two pages
+const int pageGapTime = 250;
+int inputPageStart = 0;
+int inputPageLength = 0;
+int confirmedSymbols = 0;  // Checked against the sequence as each digit is locked
+
+char playerInput[displayDigitsNumber];
+alphaOrNumber inputType = ALPHA;  // NUMBER while typing a challenge code
 int cursorPosition = 0;
-bool digitLocked[4] = {false, false, false, false};
+bool digitLocked[displayDigitsNumber] = {false};
 int selectedDigitIndex = -1;
 
 // Timing variables
-unsigned long displayStartTime = 0;
 unsigned long blinkTimer = 0;
-unsigned long joystickDebounceTime = 200;
-unsigned long buttonPressTime = 0;
-bool joystickButtonPressed = false;
-bool joystickButtonLongPressed = false;
 bool blinkState = false;
 
 // Pause button interrupt variables
@@ -130,145 +248,430 @@ volatile bool pauseButtonPressed = false;
 volatile unsigned long lastPauseInterruptTime = 0;
 const unsigned long pauseDebounceTime = 250;
 
+// Adaptive difficulty: the time each symbol is shown and the length a game
+// starts with follow the player's results, aiming at 3 rounds won out of 4
+const DifficultyConfig difficultyConfig = {
+  75,                   // targetSuccess (%)
+  200,                  // stepCredit
+  4000,                 // startSymbolTime (ms), 16 s for a full 4-symbol page
+  1000,                 // minimumSymbolTime
+  500,                  // stepSymbolTime
+  displayDigitsNumber,  // maxStartLength
+  3000,                 // comfortableFirstInput (ms)
+  4000,                 // comfortableSymbolEntry (ms per symbol)
+  8                     // comfortableExtraCycles (x4: two spare cycles per symbol)
+};
+DifficultyController difficulty(difficultyConfig);
+
+// Round telemetry, handed to the controller when the round ends
+unsigned long inputStartTime = 0;
+unsigned long firstInputTime = 0;
+bool inputSeen = false;
+unsigned int roundCycles = 0;         // Character cycles this round
+unsigned int roundMinimumCycles = 0;  // Fewest that would have done
+
 // Display timing
-int startSequenceDisplayTime = 16000;
-int sequenceDisplayTime = startSequenceDisplayTime;
-int minimumSequenceDisplayTime = 4000;
-int stepSequenceDisplayTime = 2000;
-int resultDisplayTime = 3000;
-int scoreDisplayTime = 2000;
-int pauseTextDisplayTime = 1000;  // Time to display "PAuS" before menu
+const int resultDisplayTime = 3000;
+const int scoreDisplayTime = 2000;
+const int pauseTextDisplayTime = 1000;  // Time to display "PAuS" before menu
 
 // Display buffer
-char currentDisplay[4] = {' ', ' ', ' ', ' '};
-int currentDigit = 0;
-unsigned long lastDigitChange = 0;
+char currentDisplay[displayDigitsNumber];
 const int digitDisplayTime = 5;  // ms per digit
 
-// Joystick thresholds
+// Brightness (binary code modulation): each digit slot is split into bit planes
+// lasting 1, 2, 4 and 8 units, and a digit is lit during the planes whose bit
+// is set in its 0-15 level
+const byte bcmPlanes = 4;
+const byte maxBrightness = (1 << bcmPlanes) - 1;
+byte displayBrightness = maxBrightness;  // Global level
+byte digitBrightness[displayDigitsNumber];  // Per digit, set to maxBrightness in setup()
+
+// Digits with few lit segments look brighter than full ones (the digit pin
+// shares its current between them), so they get scaled down; x/16 per lit count
+const byte segmentCountWeight[] = {16, 11, 12, 12, 13, 14, 15, 16, 16};
+
+// Optional ambient light sensor (photoresistor divider) for the global level
+const bool USE_AMBIENT_SENSOR = false;
+const int AMBIENT_SENSOR_PIN = A2;
+const int ambientDarkReading = 200;    // At or below: minimum brightness
+const int ambientBrightReading = 800;  // At or above: full brightness
+const byte ambientMinBrightness = 3;
+const unsigned long ambientSampleInterval = 500;
+
+// Display frames: what the Timer1 ISR scans out, one digit per slot.
+// loop() fills the back frame and flips frontFrame only when something changed.
+struct DisplayFrame {
+  byte segments[displayDigitsNumber];
+  DigitMask planeMask[bcmPlanes];  // Lit during this bit plane
+  DigitMask fastBlinkMask;  // Hidden during the off phase of the fast blink
+  DigitMask slowBlinkMask;  // Same for the slow blink
+};
+
+volatile DisplayFrame displayFrames[2];
+volatile byte frontFrame = 0;
+
+// Timer1 CTC, prescaler 64: the planes of one slot add up to digitDisplayTime
+const unsigned long displayTimerTicks = (F_CPU / 64 / 1000) * digitDisplayTime;
+static_assert(displayTimerTicks - 1 <= 0xFFFF, "digitDisplayTime too long for Timer1 at /64");
+
+constexpr unsigned int bcmPlaneTicks(byte plane) {
+  // Plane 3 takes whatever rounding left over, so the slot length stays exact
+  return (plane == bcmPlanes - 1) ?
+           displayTimerTicks - bcmPlaneTicks(0) - bcmPlaneTicks(1) - bcmPlaneTicks(2) :
+           (unsigned int)(displayTimerTicks * (1UL << plane) / maxBrightness);
+}
+
+const unsigned int bcmPlaneCompare[bcmPlanes] = {
+  bcmPlaneTicks(0) - 1, bcmPlaneTicks(1) - 1, bcmPlaneTicks(2) - 1, bcmPlaneTicks(3) - 1
+};
+static_assert(bcmPlaneTicks(0) >= 16, "shortest bit plane must outlast the ISR");
+
+// Joystick thresholds (an axis counts as centred again only inside the release band)
 const int joystickThresholdHigh = 800;
 const int joystickThresholdLow = 200;
+const int joystickReleaseHigh = 700;
+const int joystickReleaseLow = 300;
 const int longPressTime = 1000;
+const unsigned long joystickRepeatDelay = 400;  // Held direction: first repeat after
+const unsigned long joystickRepeatRate = 200;   // and then one every
+const unsigned long buttonDebounceTime = 20;
+const unsigned long inputSampleInterval = 10;  // ms between joystick scans
+
+// Input events: updateInput() turns joystick samples and button edges into a
+// small queue, the state handlers only consume events from it
+enum inputEvent {
+  INPUT_NONE,
+  INPUT_LEFT,
+  INPUT_RIGHT,
+  INPUT_UP,
+  INPUT_DOWN,
+  INPUT_CLICK,      // Released before longPressTime
+  INPUT_LONG_PRESS  // Held for longPressTime (no click follows)
+};
+const byte INPUT_REPEAT = 0x80;  // Or-ed onto a direction that is being held
+
+// Game events, numbered on from the input events (the state machine sees
+// both, repeats arrive as their plain direction)
+enum gameEvent {
+  EVENT_TIMEOUT = INPUT_LONG_PRESS + 1,
+  EVENT_PAUSE,
+  EVENT_MENU_PLAY,  // Posted for the selected menu item, in menuItem order
+  EVENT_MENU_SCORE,
+  EVENT_MENU_PROFILE,
+  EVENT_MENU_CODE,
+  EVENT_MENU_STOP,
+  EVENT_PLAYBACK_DONE,
+  EVENT_ROUND_WON,
+  EVENT_ROUND_LOST,
+  EVENT_SEQUENCE_COMPLETE,  // Won the round that filled the sequence buffer
+  EVENT_CODE_ENTERED,
+  EVENT_PROFILE_CHOSEN,
+  EVENT_INITIALS_ENTERED
+};
+
+const byte inputQueueSize = 8;
+byte inputQueue[inputQueueSize];
+byte inputQueueHead = 0;
+byte inputQueueCount = 0;
+
+// Background ADC scan: ADC_vect stores each result and starts the next
+// channel, so nothing waits on a conversion (the ambient sensor rides along)
+const byte adcScanChannels = USE_AMBIENT_SENSOR ? 3 : 2;
+const byte adcChannels[] = {JOYSTICK_X_PIN - A0, JOYSTICK_Y_PIN - A0, AMBIENT_SENSOR_PIN - A0};
+volatile unsigned int adcReadings[3];
+volatile byte adcScanIndex = 0;
+volatile bool adcScanDone = false;
+bool adcScanPending = false;
+unsigned long lastAdcScanTime = 0;
+unsigned int ambientReading = ambientBrightReading;
+
+struct JoystickAxis {
+  int8_t zone;  // -1 low, 0 centred, 1 high
+  unsigned long nextRepeatTime;
+};
+JoystickAxis joystickX = {0, 0};
+JoystickAxis joystickY = {0, 0};
+
+// Joystick button: INT0 timestamps every edge, updateInput() waits for the
+// bouncing to settle and times the press from its first edge
+volatile byte buttonLevel = HIGH;
+volatile bool buttonBouncing = false;
+volatile unsigned long buttonBounceStart = 0;
+volatile unsigned long buttonLastEdge = 0;
+bool buttonDown = false;
+bool longPressSent = false;
+unsigned long buttonDownTime = 0;
 
 // Blink rates
 const int fastBlinkRate = 125;  // 4 Hz
 const int slowBlinkRate = 500;  // 1 Hz
+const byte fastBlinkTicks = fastBlinkRate / digitDisplayTime;  // Display slots per phase
+const byte slowBlinkTicks = slowBlinkRate / digitDisplayTime;
+
+// Buzzer cues, played from a queue by the Timer2 interrupt. Interface sounds
+// and the success jingle wait their turn; the failure jingle cuts in.
+const ToneStep tickNotes[] PROGMEM = {toneNote(1000, 30)};
+const ToneStep clickNotes[] PROGMEM = {toneNote(1500, 50)};
+const ToneStep confirmNotes[] PROGMEM = {toneNote(1500, 50), toneNote(0, 20), toneNote(2000, 60)};
+const ToneStep successNotes[] PROGMEM = {toneNote(1500, 70), toneNote(2000, 70), toneNote(2500, 140)};
+const ToneStep failureNotes[] PROGMEM = {
+  toneNote(700, 120), toneNote(0, 40), toneNote(500, 120), toneNote(0, 40), toneNote(350, 300)
+};
 
-// Tone frequencies
-const int toneTick = 1000;
-const int toneClick = 1500;
-const int toneSuccess = 2000;
-const int toneError = 500;
-const int toneDuration = 50;
+// steps, step count, priority, queue limit
+const ToneCue cueTick PROGMEM = {tickNotes, sizeof(tickNotes) / sizeof(ToneStep), 0, 1};
+const ToneCue cueClick PROGMEM = {clickNotes, sizeof(clickNotes) / sizeof(ToneStep), 0, 2};
+const ToneCue cueConfirm PROGMEM = {confirmNotes, sizeof(confirmNotes) / sizeof(ToneStep), 0, 2};
+const ToneCue cueSuccess PROGMEM = {successNotes, sizeof(successNotes) / sizeof(ToneStep), 0, 3};
+const ToneCue cueFailure PROGMEM = {failureNotes, sizeof(failureNotes) / sizeof(ToneStep), 1, 1};
 
-const int eepromAddress = 100;
+ToneQueue<BUZZER_PIN, 4> buzzer;
 
 // Function prototypes
 void handleButtonPress();
-void updateMultiplexing();
-void writeToShiftRegister(byte data);
+void handleJoystickButtonEdge();
+void setupInput();
+void startAdcScan();
+void updateInput();
+void updateJoystickAxis(JoystickAxis& axis, unsigned int reading, byte lowEvent, byte highEvent,
+                        unsigned long currentMillis);
+void pushInputEvent(byte event);
+byte popInputEvent();
+void setupDisplayTimer();
+void updateDisplayFrame();
+void updateAmbientBrightness();
+byte countLitSegments(byte segments);
 byte getSegmentEncoding(char c);
 void setDisplayText(const char* text);
-void generateSequence();
-void handleMenu();
-void handleShowSequence();
-void handleInputPhase();
-void handleCheckAnswer();
-void handleResult();
-void handlePause();
-void handleShowScore();
-void handleShowPauseText();
-void playTone(int frequency, int duration);
+bool extendSequence();
+int getPageLength(int pageStart);
+unsigned long getPageTime(int pageStart);
+void showSequencePage(int pageStart);
+void startInputPage(int pageStart);
+void checkLockedDigit(int digit);
+void showMenuItem();
+void stepMenuItem(int step);
+unsigned int newChallengeCode();
+void scoreRound();
+void recordRound(bool won);
+void printDwellTimes();
+void saveGame();
+void showProfile();
+void printTopScores();
+void printGameLog();
+void updateSerialCommands();
+
+// State hooks and transition actions
+void enterMenu();
+void enterShowSequence();
+void enterInputPhase();
+void enterPause();
+void enterShowPauseText();
+void selectNextMenuItem();
+void selectPreviousMenuItem();
+void confirmMenuItem();
+void startGame();
+void startChallenge();
+void enterShowCode();
+void enterCodeEntry();
+void clickEntryDigit();
+void confirmCode();
+void browseProfiles();
+void enterProfileSelect();
+void selectNextProfile();
+void selectPreviousProfile();
+void chooseProfile();
+void enterInitialsEntry();
+void confirmInitials();
+void showHighScore();
+void showStopText();
+void returnToMenu();
+void resumeGame();
+void stopGame();
+void stopGameShowScore();
+void advancePlayback();
+void moveCursorLeft();
+void moveCursorRight();
+void cycleCharacterUp();
+void cycleCharacterDown();
+void clickDigit();
+void submitAnswer();
+void winRound();
+void loseRound();
+void completeSequence();
+void startNextRound();
+void endGame();
 char getCharFromIndex(int index, alphaOrNumber type);
 int getIndexFromChar(char c, alphaOrNumber type);
 
+// State table: enter, exit, update, timeout (ms, 0 = armed by the enter hook if at all)
+const StateHandlers gameStates[STATE_COUNT] PROGMEM = {
+  {enterMenu,           nullptr, nullptr, 0},                     // STATE_MENU
+  {enterShowSequence,   nullptr, nullptr, 0},                     // STATE_SHOW_SEQUENCE
+  {enterInputPhase,     nullptr, nullptr, 0},                     // STATE_INPUT_PHASE
+  {nullptr,             nullptr, nullptr, resultDisplayTime},     // STATE_ROUND_WON
+  {nullptr,             nullptr, nullptr, resultDisplayTime},     // STATE_GAME_OVER
+  {enterPause,          nullptr, nullptr, 0},                     // STATE_PAUSE
+  {nullptr,             nullptr, nullptr, scoreDisplayTime},      // STATE_SHOW_SCORE
+  {enterShowPauseText,  nullptr, nullptr, pauseTextDisplayTime},  // STATE_SHOW_PAUSE_TEXT
+  {enterShowCode,       nullptr, nullptr, codeDisplayTime},       // STATE_SHOW_CODE
+  {enterCodeEntry,      nullptr, nullptr, 0},                     // STATE_ENTER_CODE
+  {enterProfileSelect,  nullptr, nullptr, 0},                     // STATE_SELECT_PROFILE
+  {enterInitialsEntry,  nullptr, nullptr, 0},                     // STATE_EDIT_INITIALS
+};
+
+typedef StateMachine<STATE_COUNT> GameStateMachine;
+const byte STAY = GameStateMachine::STAY;
+
+// Transition table: state, event -> next state, action
+const StateTransition gameTransitions[] PROGMEM = {
+  {STATE_MENU,            INPUT_DOWN,              STAY,                  selectNextMenuItem},
+  {STATE_MENU,            INPUT_UP,                STAY,                  selectPreviousMenuItem},
+  {STATE_MENU,            INPUT_CLICK,             STAY,                  confirmMenuItem},
+  {STATE_MENU,            EVENT_MENU_PLAY,         STATE_SHOW_CODE,       startGame},
+  {STATE_MENU,            EVENT_MENU_SCORE,        STATE_SHOW_SCORE,      showHighScore},
+  {STATE_MENU,            EVENT_MENU_PROFILE,      STATE_SELECT_PROFILE,  browseProfiles},
+  {STATE_MENU,            EVENT_MENU_CODE,         STATE_ENTER_CODE,      nullptr},
+  {STATE_MENU,            EVENT_MENU_STOP,         STATE_SHOW_SCORE,      showStopText},
+  
+  {STATE_ENTER_CODE,      INPUT_LEFT,              STAY,                  moveCursorLeft},
+  {STATE_ENTER_CODE,      INPUT_RIGHT,             STAY,                  moveCursorRight},
+  {STATE_ENTER_CODE,      INPUT_DOWN,              STAY,                  cycleCharacterUp},
+  {STATE_ENTER_CODE,      INPUT_UP,                STAY,                  cycleCharacterDown},
+  {STATE_ENTER_CODE,      INPUT_CLICK,             STAY,                  clickEntryDigit},
+  {STATE_ENTER_CODE,      INPUT_LONG_PRESS,        STAY,                  confirmCode},
+  {STATE_ENTER_CODE,      EVENT_CODE_ENTERED,      STATE_SHOW_CODE,       startChallenge},
+  {STATE_ENTER_CODE,      EVENT_PAUSE,             STATE_MENU,            nullptr},
+  {STATE_SHOW_CODE,       EVENT_TIMEOUT,           STATE_SHOW_SEQUENCE,   nullptr},
+  
+  {STATE_SELECT_PROFILE,  INPUT_DOWN,              STAY,                  selectNextProfile},
+  {STATE_SELECT_PROFILE,  INPUT_UP,                STAY,                  selectPreviousProfile},
+  {STATE_SELECT_PROFILE,  INPUT_CLICK,             STAY,                  chooseProfile},
+  {STATE_SELECT_PROFILE,  INPUT_LONG_PRESS,        STATE_EDIT_INITIALS,   nullptr},
+  {STATE_SELECT_PROFILE,  EVENT_PROFILE_CHOSEN,    STATE_MENU,            nullptr},
+  {STATE_SELECT_PROFILE,  EVENT_PAUSE,             STATE_MENU,            nullptr},
+  
+  {STATE_EDIT_INITIALS,   INPUT_LEFT,              STAY,                  moveCursorLeft},
+  {STATE_EDIT_INITIALS,   INPUT_RIGHT,             STAY,                  moveCursorRight},
+  {STATE_EDIT_INITIALS,   INPUT_DOWN,              STAY,                  cycleCharacterUp},
+  {STATE_EDIT_INITIALS,   INPUT_UP,                STAY,                  cycleCharacterDown},
+  {STATE_EDIT_INITIALS,   INPUT_CLICK,             STAY,                  clickEntryDigit},
+  {STATE_EDIT_INITIALS,   INPUT_LONG_PRESS,        STAY,                  confirmInitials},
+  {STATE_EDIT_INITIALS,   EVENT_INITIALS_ENTERED,  STATE_SELECT_PROFILE,  nullptr},
+  {STATE_EDIT_INITIALS,   EVENT_PAUSE,             STATE_SELECT_PROFILE,  nullptr},
+  
+  {STATE_SHOW_SEQUENCE,   EVENT_TIMEOUT,           STAY,                  advancePlayback},
+  {STATE_SHOW_SEQUENCE,   EVENT_PLAYBACK_DONE,     STATE_INPUT_PHASE,     nullptr},
+  {STATE_SHOW_SEQUENCE,   EVENT_PAUSE,             STATE_SHOW_PAUSE_TEXT, nullptr},
+  
+  {STATE_INPUT_PHASE,     INPUT_LEFT,              STAY,                  moveCursorLeft},
+  {STATE_INPUT_PHASE,     INPUT_RIGHT,             STAY,                  moveCursorRight},
+  {STATE_INPUT_PHASE,     INPUT_DOWN,              STAY,                  cycleCharacterUp},
+  {STATE_INPUT_PHASE,     INPUT_UP,                STAY,                  cycleCharacterDown},
+  {STATE_INPUT_PHASE,     INPUT_CLICK,             STAY,                  clickDigit},
+  {STATE_INPUT_PHASE,     INPUT_LONG_PRESS,        STAY,                  submitAnswer},
+  {STATE_INPUT_PHASE,     EVENT_ROUND_WON,         STATE_ROUND_WON,       winRound},
+  {STATE_INPUT_PHASE,     EVENT_ROUND_LOST,        STATE_GAME_OVER,       loseRound},
+  {STATE_INPUT_PHASE,     EVENT_SEQUENCE_COMPLETE, STATE_GAME_OVER,       completeSequence},
+  {STATE_INPUT_PHASE,     EVENT_PAUSE,             STATE_SHOW_PAUSE_TEXT, nullptr},
+  
+  {STATE_ROUND_WON,       EVENT_TIMEOUT,           STATE_SHOW_SEQUENCE,   startNextRound},
+  {STATE_GAME_OVER,       EVENT_TIMEOUT,           STATE_MENU,            endGame},
+  {STATE_SHOW_SCORE,      EVENT_TIMEOUT,           STATE_MENU,            returnToMenu},
+  {STATE_SHOW_PAUSE_TEXT, EVENT_TIMEOUT,           STATE_PAUSE,           nullptr},
+  
+  {STATE_PAUSE,           INPUT_DOWN,              STAY,                  selectNextMenuItem},
+  {STATE_PAUSE,           INPUT_UP,                STAY,                  selectPreviousMenuItem},
+  {STATE_PAUSE,           INPUT_CLICK,             STAY,                  confirmMenuItem},
+  {STATE_PAUSE,           EVENT_MENU_PLAY,         STATE_SHOW_SEQUENCE,   resumeGame},
+  {STATE_PAUSE,           EVENT_MENU_SCORE,        STATE_SHOW_SCORE,      stopGameShowScore},
+  {STATE_PAUSE,           EVENT_MENU_STOP,         STATE_MENU,            stopGame},
+};
+
+GameStateMachine game(gameStates, gameTransitions,
+                      sizeof(gameTransitions) / sizeof(gameTransitions[0]), EVENT_TIMEOUT);
+
 void setup() {
   Serial.begin(9600);
   
-  highScore = EEPROM.read(eepromAddress);
+  // A fresh store takes over the old single-byte high score (0xFF = never set)
+  byte legacyHighScore = EEPROM.read(recordsAddress);
+  if (!records.begin()) {
+    char initials[Records::INITIALS];
+    for (byte profile = 0; profile < profileCount; profile++) {
+      for (byte i = 0; i < Records::INITIALS; i++) {
+        initials[i] = charSet[profile];
+      }
+      records.setInitials(profile, initials);
+    }
+    if (legacyHighScore != 0xFF) {
+      records.insertScore(0, legacyHighScore, Records::NO_CODE);
+    }
+  }
 
-  // Initialize SPI communication
-  SPI.begin();
+  // Shift register chain on hardware SPI (also sets up the latch pin)
+  Display::begin();
   
   // Setup input pins
-  pinMode(JOYSTICK_BUTTON_PIN, INPUT_PULLUP);
   pinMode(PUSHBUTTON_PIN, INPUT_PULLUP);
-  pinMode(BUZZER_PIN, OUTPUT);
+  buzzer.begin();
   
   // Setup digit control pins (common cathode - HIGH = off)
+  if (!Display::selectsDigits) {
+    for (int digit = 0; digit < displayDigitsNumber; digit++) {
+      pinMode(displayDigits[digit], OUTPUT);
+      digitalWrite(displayDigits[digit], HIGH);
+    }
+  }
+  
   for (int digit = 0; digit < displayDigitsNumber; digit++) {
-    pinMode(displayDigits[digit], OUTPUT);
-    digitalWrite(displayDigits[digit], HIGH);
+    digitBrightness[digit] = maxBrightness;
   }
   
-  // Setup joystick analog pins
-  pinMode(JOYSTICK_X_PIN, INPUT);
-  pinMode(JOYSTICK_Y_PIN, INPUT);
+  // Joystick: background ADC scans and button edge interrupt
+  setupInput();
   
-  // Setup SPI latch pin
-  pinMode(CS_PIN, OUTPUT);
-  digitalWrite(CS_PIN, HIGH);
+  // Start scanning the display from the timer interrupt
+  setupDisplayTimer();
   
   // Attach interrupt for pause button
   attachInterrupt(digitalPinToInterrupt(PUSHBUTTON_PIN), handleButtonPress, FALLING);
   
-  // Initialize display
-  setDisplayText(textPlay);
+  // Start in the menu (shows "PLAY")
+  game.begin(STATE_MENU);
   
   Serial.println("Simon Says game started!");
   Serial.println("Use the joystick to navigate the menu and play!");
+  Serial.println("Send 'l' for the game log, 't' for the top scores.");
 }
 
 void loop() {
-  unsigned long currentMillis = millis();
+  // Turn joystick samples and button edges into events
+  updateInput();
+  
+  // Publish the display contents (the Timer1 ISR does the scanning)
+  updateAmbientBrightness();
+  updateDisplayFrame();
   
-  // Always update multiplexing
-  updateMultiplexing();
-  
-  // Check for pause button press during game states
-  if (pauseButtonPressed && (currentState == STATE_SHOW_SEQUENCE || currentState == STATE_INPUT_PHASE)) {
-    pauseButtonPressed = false;  // Reset flag
-    currentState = STATE_SHOW_PAUSE_TEXT;
-    setDisplayText(textPause);
-    displayStartTime = currentMillis;
-    playTone(toneClick, toneDuration);
-    Serial.println("Game paused...");
-  }
-  
-  // State machine
-  switch (currentState) {
-    case STATE_MENU:
-      handleMenu();
-      break;
-      
-    case STATE_SHOW_SEQUENCE:
-      handleShowSequence();
-      break;
-      
-    case STATE_INPUT_PHASE:
-      handleInputPhase();
-      break;
-      
-    case STATE_CHECK_ANSWER:
-      handleCheckAnswer();
-      break;
-      
-    case STATE_RESULT:
-      handleResult();
-      break;
-      
-    case STATE_PAUSE:
-      handlePause();
-      break;
-      
-    case STATE_SHOW_SCORE:
-      handleShowScore();
-      break;
-      
-    case STATE_SHOW_PAUSE_TEXT:
-      handleShowPauseText();
-      break;
+  // Pause button (only the sequence and input states react to it)
+  if (pauseButtonPressed) {
+    pauseButtonPressed = false;
+    game.dispatch(EVENT_PAUSE);
   }
+  
+  // Every queued input event, then any due timeout
+  byte event;
+  while ((event = popInputEvent()) != INPUT_NONE) {
+    if (game.getState() == STATE_INPUT_PHASE && !inputSeen) {
+      inputSeen = true;
+      firstInputTime = millis() - inputStartTime;
+    }
+    game.dispatch(event & ~INPUT_REPEAT);
+  }
+  game.update();
+  
+  updateSerialCommands();
 }
 
 void handleButtonPress() {
@@ -281,524 +684,917 @@ void handleButtonPress() {
   }
 }
 
-void updateMultiplexing() {
-  unsigned long currentMillis = millis();
+void handleJoystickButtonEdge() {
+  unsigned long currentTime = millis();
   
-  if (currentMillis - lastDigitChange >= digitDisplayTime) {
-    // Turn off current digit
-    digitalWrite(displayDigits[currentDigit], HIGH);
-    
-    // Move to next digit
-    currentDigit = (currentDigit + 1) % displayDigitsNumber;
-    
-    // Determine if we should display this digit (for blinking effects)
-    bool shouldDisplay = true;
-    
-    if (currentState == STATE_INPUT_PHASE) {
-      // Fast blink for selected digit (not locked)
-      if (selectedDigitIndex == currentDigit && !digitLocked[currentDigit]) {
-        if ((currentMillis / fastBlinkRate) % 2 == 0) {
-          shouldDisplay = false;
-        }
-      }
-      // Slow blink for locked digits
-      else if (digitLocked[currentDigit]) {
-        if ((currentMillis / slowBlinkRate) % 2 == 0) {
-          shouldDisplay = false;
-        }
-      }
-    }
-    
-    if (shouldDisplay) {
-      // Get segment encoding for current character
-      byte segments = getSegmentEncoding(currentDisplay[currentDigit]);
-      
-      // Write to shift register via SPI
-      writeToShiftRegister(segments);
-      
-      // Turn on current digit (LOW for common cathode)
-      digitalWrite(displayDigits[currentDigit], LOW);
-    }
-    
-    lastDigitChange = currentMillis;
+  buttonLevel = digitalRead(JOYSTICK_BUTTON_PIN);
+  if (!buttonBouncing) {
+    buttonBouncing = true;
+    buttonBounceStart = currentTime;
   }
+  buttonLastEdge = currentTime;
 }
 
-void writeToShiftRegister(byte data) {
-  digitalWrite(CS_PIN, LOW);    // Latch LOW - prepare to receive data
-  SPI.transfer(data);            // Transfer byte via SPI
-  digitalWrite(CS_PIN, HIGH);   // Latch HIGH - output the data
-}
-
-byte getSegmentEncoding(char c) {
-  // Check character set
-  for (int i = 0; i < charSetSize; i++) {
-    if (charSet[i] == c) {
-      return charSegmentEncoding[i];
-    }
-  }
+void setupInput() {
+  pinMode(JOYSTICK_X_PIN, INPUT);
+  pinMode(JOYSTICK_Y_PIN, INPUT);
+  pinMode(JOYSTICK_BUTTON_PIN, INPUT_PULLUP);
   
-  // Check number set
-  for (int i = 0; i < numberSetSize; i++) {
-    if (numberSet[i] == c) {
-      return numberSegmentEncoding[i];
-    }
-  }
+  buttonLevel = digitalRead(JOYSTICK_BUTTON_PIN);
+  attachInterrupt(digitalPinToInterrupt(JOYSTICK_BUTTON_PIN), handleJoystickButtonEdge, CHANGE);
   
-  // Return blank space by default
-  return 0b00000000;
+  startAdcScan();
 }
 
-void setDisplayText(const char* text) {
-  for (int i = 0; i < displayDigitsNumber; i++) {
-    if (text[i] != '\0') {
-      currentDisplay[i] = text[i];
-    } else {
-      currentDisplay[i] = ' ';
-    }
+// The ADC is ours alone (nothing calls analogRead()), each scan converts
+// adcScanChannels channels back to back, ~104 us apiece
+ISR(ADC_vect) {
+  adcReadings[adcScanIndex] = ADC;
+  
+  if (++adcScanIndex < adcScanChannels) {
+    ADMUX = _BV(REFS0) | adcChannels[adcScanIndex];
+    ADCSRA |= _BV(ADSC);
+  }
+  else {
+    ADCSRA &= ~_BV(ADIE);
+    adcScanDone = true;
   }
 }
 
-void generateSequence() {
-  for (int i = 0; i < displayDigitsNumber; i++) {
-    gameSequence[i] = charSet[random(charSetSize)];
-  }
+void startAdcScan() {
+  noInterrupts();
+  adcScanIndex = 0;
+  adcScanDone = false;
+  ADMUX = _BV(REFS0) | adcChannels[0];  // AVcc reference, same as analogRead()
+  ADCSRA |= _BV(ADIE) | _BV(ADSC);
+  interrupts();
+  
+  adcScanPending = true;
+  lastAdcScanTime = millis();
 }
 
-void handleMenu() {
-  static unsigned long lastJoystickReading = 0;
+void updateInput() {
   unsigned long currentMillis = millis();
   
-  // Handle joystick navigation
-  if (currentMillis - lastJoystickReading >= joystickDebounceTime) {
-    int joystickYValue = analogRead(JOYSTICK_Y_PIN);
+  // Joystick: classify a finished scan, start the next one on schedule
+  if (adcScanPending && adcScanDone) {
+    noInterrupts();
+    unsigned int xReading = adcReadings[0];
+    unsigned int yReading = adcReadings[1];
+    unsigned int lightReading = adcReadings[2];
+    interrupts();
     
-    if (joystickYValue > joystickThresholdHigh) {
-      // Navigate down
-      currentMenuItem = (menuItem)((currentMenuItem + 1) % 3);
-      playTone(toneTick, toneDuration);
-      
-      switch (currentMenuItem) {
-        case MENU_PLAY:
-          setDisplayText(textPlay);
-          break;
-        case MENU_SCORE:
-          setDisplayText(textScore);
-          break;
-        case MENU_STOP:
-          setDisplayText(textStop);
-          break;
-      }
-      
-      lastJoystickReading = currentMillis;
-    }
-    else if (joystickYValue < joystickThresholdLow) {
-      // Navigate up
-      currentMenuItem = (menuItem)((currentMenuItem - 1 + 3) % 3);
-      playTone(toneTick, toneDuration);
-      
-      switch (currentMenuItem) {
-        case MENU_PLAY:
-          setDisplayText(textPlay);
-          break;
-        case MENU_SCORE:
-          setDisplayText(textScore);
-          break;
-        case MENU_STOP:
-          setDisplayText(textStop);
-          break;
-      }
-      
-      lastJoystickReading = currentMillis;
+    // The low bits jitter even with the stick at rest
+    entropyPool = ((entropyPool << 7) | (entropyPool >> 25)) ^ xReading ^
+                  ((unsigned long)yReading << 11) ^ ((unsigned long)lightReading << 21);
+    
+    adcScanPending = false;
+    updateJoystickAxis(joystickX, xReading, INPUT_LEFT, INPUT_RIGHT, currentMillis);
+    updateJoystickAxis(joystickY, yReading, INPUT_UP, INPUT_DOWN, currentMillis);
+    if (USE_AMBIENT_SENSOR) {
+      ambientReading = lightReading;
     }
   }
   
-  // Handle joystick button press
-  if (digitalRead(JOYSTICK_BUTTON_PIN) == LOW && !joystickButtonPressed) {
-    joystickButtonPressed = true;
-    playTone(toneClick, toneDuration);
-    
-    switch (currentMenuItem) {
-      case MENU_PLAY:
-        currentRound = 1;
-        sequenceDisplayTime = startSequenceDisplayTime;
-        generateSequence();
-        currentState = STATE_SHOW_SEQUENCE;
-        displayStartTime = currentMillis;
-        setDisplayText(gameSequence);
-        Serial.println("Game started! Memorize the sequence...");
-        break;
-        
-      case MENU_SCORE:
-        {
-          char scoreText[5];
-          sprintf(scoreText, "%4d", highScore);
-          setDisplayText(scoreText);
-          currentState = STATE_SHOW_SCORE;
-          displayStartTime = currentMillis;
-          Serial.print("High score: ");
-          Serial.println(highScore);
-        }
-        break;
-        
-      case MENU_STOP:
-        setDisplayText(textStop);
-        displayStartTime = currentMillis;
-        currentState = STATE_SHOW_SCORE;
-        break;
+  if (!adcScanPending && currentMillis - lastAdcScanTime >= inputSampleInterval) {
+    startAdcScan();
+  }
+  
+  // Button: take the new level once it has been quiet for buttonDebounceTime
+  noInterrupts();
+  bool settled = buttonBouncing && (currentMillis - buttonLastEdge >= buttonDebounceTime);
+  bool down = (buttonLevel == LOW);
+  unsigned long edgeTime = buttonBounceStart;
+  if (settled) {
+    buttonBouncing = false;
+  }
+  interrupts();
+  
+  if (settled && down != buttonDown) {
+    buttonDown = down;
+    if (down) {
+      buttonDownTime = edgeTime;
+      longPressSent = false;
+    }
+    else if (!longPressSent) {
+      pushInputEvent(INPUT_CLICK);
     }
   }
   
-  if (digitalRead(JOYSTICK_BUTTON_PIN) == HIGH) {
-    joystickButtonPressed = false;
+  // Long press fires while still held, timed from the press edge
+  if (buttonDown && !longPressSent && currentMillis - buttonDownTime >= longPressTime) {
+    longPressSent = true;
+    pushInputEvent(INPUT_LONG_PRESS);
   }
 }
 
-void handleShowSequence() {
-  unsigned long currentMillis = millis();
+void updateJoystickAxis(JoystickAxis& axis, unsigned int reading, byte lowEvent, byte highEvent,
+                        unsigned long currentMillis) {
+  int8_t zone = axis.zone;
+  if (reading > joystickThresholdHigh) {
+    zone = 1;
+  }
+  else if (reading < joystickThresholdLow) {
+    zone = -1;
+  }
+  else if (reading >= joystickReleaseLow && reading <= joystickReleaseHigh) {
+    zone = 0;
+  }
   
-  if (currentMillis - displayStartTime >= sequenceDisplayTime) {
-    // Transition to input phase
-    currentState = STATE_INPUT_PHASE;
-    cursorPosition = 0;
-    selectedDigitIndex = -1;
-    
-    // Initialize player input with first character
-    for (int digit = 0; digit < displayDigitsNumber; digit++) {
-      playerInput[digit] = charSet[0];
-      digitLocked[digit] = false;
+  byte event = (zone > 0) ? highEvent : lowEvent;
+  if (zone != axis.zone) {
+    axis.zone = zone;
+    if (zone != 0) {
+      pushInputEvent(event);
+      axis.nextRepeatTime = currentMillis + joystickRepeatDelay;
     }
-    
-    setDisplayText(playerInput);
-    Serial.println("Your turn! Enter the sequence...");
+  }
+  else if (zone != 0 && (long)(currentMillis - axis.nextRepeatTime) >= 0) {
+    pushInputEvent(event | INPUT_REPEAT);
+    axis.nextRepeatTime += joystickRepeatRate;
   }
 }
 
-void handleInputPhase() {
-  static unsigned long lastJoystickReading = 0;
-  static unsigned long buttonDownTime = 0;
-  static bool buttonWasPressed = false;
-  unsigned long currentMillis = millis();
+void pushInputEvent(byte event) {
+  // A full queue drops the newest event (only happens if nothing consumes them)
+  if (inputQueueCount >= inputQueueSize) {
+    return;
+  }
+  inputQueue[(inputQueueHead + inputQueueCount) % inputQueueSize] = event;
+  inputQueueCount++;
+}
+
+byte popInputEvent() {
+  if (inputQueueCount == 0) {
+    return INPUT_NONE;
+  }
+  byte event = inputQueue[inputQueueHead];
+  inputQueueHead = (inputQueueHead + 1) % inputQueueSize;
+  inputQueueCount--;
+  return event;
+}
+
+void setupDisplayTimer() {
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM12) | _BV(CS11) | _BV(CS10);  // CTC on OCR1A, clk/64
+  TCNT1 = 0;
+  OCR1A = bcmPlaneCompare[0];
+  TIMSK1 = _BV(OCIE1A);
+  interrupts();
+}
+
+// Display scan: one interrupt per bit plane, bcmPlanes per digit slot, the
+// same few steps every time whatever loop() is doing
+ISR(TIMER1_COMPA_vect) {
+  static byte scanDigit = 0;
+  static byte plane = bcmPlanes - 1;
+  static DigitMask hiddenMask = 0;
+  static bool chainLit = false;
+  static byte fastPhaseTicks = fastBlinkTicks;
+  static byte slowPhaseTicks = slowBlinkTicks;
+  static bool fastBlinkOn = false;
+  static bool slowBlinkOn = false;
+  
+  const volatile DisplayFrame& frame = displayFrames[frontFrame];
   
-  // Handle cursor movement (left/right) - only when no digit selected
-  if (selectedDigitIndex == -1 && currentMillis - lastJoystickReading >= joystickDebounceTime) {
-    int joystickXValue = analogRead(JOYSTICK_X_PIN);
+  if (++plane >= bcmPlanes) {
+    plane = 0;
+    
+    // Turn off current digit
+    if (!Display::selectsDigits) {
+      DigitSelect::write(digitSelectImages[digitSelectOff]);
+    }
+    
+    // Move to next digit
+    if (++scanDigit >= displayDigitsNumber) {
+      scanDigit = 0;
+    }
     
-    if (joystickXValue > joystickThresholdHigh) {
-      // Move right
-      cursorPosition = (cursorPosition + 1) % 4;
-      playTone(toneTick, toneDuration);
-      lastJoystickReading = currentMillis;
-      Serial.print("Cursor at position: ");
-      Serial.println(cursorPosition);
+    // Blink phases, counted in display slots
+    if (--fastPhaseTicks == 0) {
+      fastPhaseTicks = fastBlinkTicks;
+      fastBlinkOn = !fastBlinkOn;
     }
-    else if (joystickXValue < joystickThresholdLow) {
-      // Move left
-      cursorPosition = (cursorPosition - 1 + 4) % 4;
-      playTone(toneTick, toneDuration);
-      lastJoystickReading = currentMillis;
-      Serial.print("Cursor at position: ");
-      Serial.println(cursorPosition);
+    if (--slowPhaseTicks == 0) {
+      slowPhaseTicks = slowBlinkTicks;
+      slowBlinkOn = !slowBlinkOn;
+    }
+    hiddenMask = (fastBlinkOn ? 0 : frame.fastBlinkMask) | (slowBlinkOn ? 0 : frame.slowBlinkMask);
+    
+    if (!Display::selectsDigits) {
+      Display::show(scanDigit, frame.segments[scanDigit]);
     }
   }
   
-  // Handle character cycling (up/down) - only when digit selected
-  if (selectedDigitIndex != -1 && !digitLocked[selectedDigitIndex]) {
-    if (currentMillis - lastJoystickReading >= joystickDebounceTime) {
-      int joystickYValue = analogRead(JOYSTICK_Y_PIN);
-      
-      if (joystickYValue > joystickThresholdHigh) {
-        // Cycle up
-        int currentIndex = getIndexFromChar(playerInput[selectedDigitIndex], ALPHA);
-        currentIndex = (currentIndex + 1) % charSetSize;
-        playerInput[selectedDigitIndex] = charSet[currentIndex];
-        setDisplayText(playerInput);
-        playTone(toneTick, toneDuration);
-        lastJoystickReading = currentMillis;
-      }
-      else if (joystickYValue < joystickThresholdLow) {
-        // Cycle down
-        int currentIndex = getIndexFromChar(playerInput[selectedDigitIndex], ALPHA);
-        currentIndex = (currentIndex - 1 + charSetSize) % charSetSize;
-        playerInput[selectedDigitIndex] = charSet[currentIndex];
-        setDisplayText(playerInput);
-        playTone(toneTick, toneDuration);
-        lastJoystickReading = currentMillis;
+  OCR1A = bcmPlaneCompare[plane];
+  
+  // Digit on (LOW for common cathode) for the planes set in its level
+  DigitMask digitBit = (DigitMask)(1U << scanDigit);
+  bool lit = (frame.planeMask[plane] & digitBit) && !(hiddenMask & digitBit);
+  
+  if (Display::selectsDigits) {
+    // Select and segments go out together in one SPI burst, only when they change
+    if (plane == 0 || lit != chainLit) {
+      if (lit) {
+        Display::show(scanDigit, frame.segments[scanDigit]);
+      } else {
+        Display::blank();
       }
+      chainLit = lit;
     }
+  } else {
+    DigitSelect::write(digitSelectImages[lit ? scanDigit : digitSelectOff]);
   }
+}
+
+// Buzzer: a toggle and a countdown per compare match, see ToneQueue.hpp
+ISR(TIMER2_COMPA_vect) {
+  buzzer.tick();
+}
+
+byte countLitSegments(byte segments) {
+  byte count = 0;
+  for (byte bits = segments & 0x7F; bits; bits &= bits - 1) {  // DP not counted
+    count++;
+  }
+  return count;
+}
+
+void updateAmbientBrightness() {
+  static unsigned long lastAmbientSample = 0;
   
-  // Handle joystick button
-  int buttonState = digitalRead(JOYSTICK_BUTTON_PIN);
-  
-  if (buttonState == LOW && !buttonWasPressed) {
-    buttonWasPressed = true;
-    buttonDownTime = currentMillis;
+  if (!USE_AMBIENT_SENSOR || millis() - lastAmbientSample < ambientSampleInterval) {
+    return;
   }
+  lastAmbientSample = millis();
   
-  if (buttonState == LOW && buttonWasPressed) {
-    // Check for long press
-    if (currentMillis - buttonDownTime >= longPressTime && !joystickButtonLongPressed) {
-      joystickButtonLongPressed = true;
-      playTone(toneClick, toneDuration * 2);
-      currentState = STATE_CHECK_ANSWER;
-      Serial.println("Answer submitted!");
-    }
+  int reading = constrain((int)ambientReading, ambientDarkReading, ambientBrightReading);
+  displayBrightness = map(reading, ambientDarkReading, ambientBrightReading,
+                          ambientMinBrightness, maxBrightness);
+}
+
+void updateDisplayFrame() {
+  DisplayFrame next;
+  next.fastBlinkMask = 0;
+  next.slowBlinkMask = 0;
+  for (byte plane = 0; plane < bcmPlanes; plane++) {
+    next.planeMask[plane] = 0;
   }
   
-  if (buttonState == HIGH && buttonWasPressed) {
-    // Short press handling
-    if (!joystickButtonLongPressed) {
-      if (selectedDigitIndex == -1) {
-        // Select digit
-        selectedDigitIndex = cursorPosition;
-        digitLocked[selectedDigitIndex] = false;
-        playTone(toneClick, toneDuration);
-        Serial.print("Digit ");
-        Serial.print(selectedDigitIndex);
-        Serial.println(" selected. Use Up/Down to change character.");
-      }
-      else if (selectedDigitIndex == cursorPosition && !digitLocked[selectedDigitIndex]) {
-        // Lock digit and deselect
-        digitLocked[selectedDigitIndex] = true;
-        selectedDigitIndex = -1;
-        playTone(toneClick, toneDuration);
-        Serial.print("Digit ");
-        Serial.print(cursorPosition);
-        Serial.println(" locked.");
+  for (byte digit = 0; digit < displayDigitsNumber; digit++) {
+    next.segments[digit] = getSegmentEncoding(currentDisplay[digit]);
+    
+    // Level = global x per-digit x lit-segment compensation, rounded
+    byte weight = segmentCountWeight[countLitSegments(next.segments[digit])];
+    unsigned int level = ((unsigned int)displayBrightness * digitBrightness[digit] * weight +
+                          (maxBrightness * 16) / 2) / (maxBrightness * 16);
+    for (byte plane = 0; plane < bcmPlanes; plane++) {
+      if (level & (1 << plane)) {
+        next.planeMask[plane] |= (DigitMask)(1U << digit);
       }
     }
     
-    buttonWasPressed = false;
-    joystickButtonLongPressed = false;
+    byte state = game.getState();
+    if (state == STATE_INPUT_PHASE || state == STATE_ENTER_CODE || state == STATE_EDIT_INITIALS) {
+      // Fast blink for selected digit (not locked), slow blink for locked digits
+      if (selectedDigitIndex == digit && !digitLocked[digit]) {
+        next.fastBlinkMask |= (DigitMask)(1U << digit);
+      } else if (digitLocked[digit]) {
+        next.slowBlinkMask |= (DigitMask)(1U << digit);
+      }
+    }
+  }
+  
+  // Nothing to do unless the frame on screen is out of date
+  const volatile DisplayFrame& front = displayFrames[frontFrame];
+  bool changed = (next.fastBlinkMask != front.fastBlinkMask) ||
+                 (next.slowBlinkMask != front.slowBlinkMask);
+  for (byte digit = 0; digit < displayDigitsNumber && !changed; digit++) {
+    changed = (next.segments[digit] != front.segments[digit]);
   }
+  for (byte plane = 0; plane < bcmPlanes && !changed; plane++) {
+    changed = (next.planeMask[plane] != front.planeMask[plane]);
+  }
+  if (!changed) {
+    return;
+  }
+  
+  // Fill the back frame, then flip (a single byte store, so the ISR sees either frame whole)
+  byte backFrame = frontFrame ^ 1;
+  volatile DisplayFrame& back = displayFrames[backFrame];
+  for (byte digit = 0; digit < displayDigitsNumber; digit++) {
+    back.segments[digit] = next.segments[digit];
+  }
+  for (byte plane = 0; plane < bcmPlanes; plane++) {
+    back.planeMask[plane] = next.planeMask[plane];
+  }
+  back.fastBlinkMask = next.fastBlinkMask;
+  back.slowBlinkMask = next.slowBlinkMask;
+  frontFrame = backFrame;
 }
 
-void handleCheckAnswer() {
-  bool correct = true;
-  
+byte getSegmentEncoding(char c) {
+  // Anything outside the table (or not in either set) shows as a blank digit
+  byte ascii = (byte)c;
+  if (ascii >= asciiTableSize) {
+    return 0b00000000;
+  }
+  return pgm_read_byte(&asciiSegments[ascii]);
+}
+
+void setDisplayText(const char* text) {
+  // Shorter texts are padded with blanks (never read past their terminator)
+  bool ended = false;
   for (int i = 0; i < displayDigitsNumber; i++) {
-    if (playerInput[i] != gameSequence[i]) {
-      correct = false;
-      break;
+    if (!ended && text[i] == '\0') {
+      ended = true;
     }
+    currentDisplay[i] = ended ? ' ' : text[i];
+  }
+}
+
+bool extendSequence() {
+  return gameSequence.append(sequenceRandom.nextBelow(charSetSize));
+}
+
+int getPageLength(int pageStart) {
+  return min(displayDigitsNumber, (int)gameSequence.length() - pageStart);
+}
+
+unsigned long getPageTime(int pageStart) {
+  return (unsigned long)difficulty.getSymbolTime() * getPageLength(pageStart);
+}
+
+void showSequencePage(int pageStart) {
+  int pageLength = getPageLength(pageStart);
+  for (int digit = 0; digit < displayDigitsNumber; digit++) {
+    currentDisplay[digit] = (digit < pageLength) ? charSet[gameSequence.get(pageStart + digit)] : ' ';
   }
+}
+
+void startInputPage(int pageStart) {
+  inputPageStart = pageStart;
+  inputPageLength = getPageLength(pageStart);
+  cursorPosition = 0;
+  selectedDigitIndex = -1;
   
-  if (correct) {
-    playTone(toneSuccess, toneDuration * 3);
-    currentRound++;
-    
-    if (currentRound - 1 > highScore) {
-      highScore = currentRound - 1;
-      EEPROM.update(eepromAddress, highScore);
+  // Initialize player input with first character, digits past the end stay blank
+  for (int digit = 0; digit < displayDigitsNumber; digit++) {
+    playerInput[digit] = (digit < inputPageLength) ? charSet[0] : ' ';
+    digitLocked[digit] = false;
+  }
+  
+  setDisplayText(playerInput);
+}
 
-    }
-    
-    sequenceDisplayTime = max(minimumSequenceDisplayTime, sequenceDisplayTime - stepSequenceDisplayTime);
-    
-    char scoreText[5];
-    sprintf(scoreText, "%4d", currentRound - 1);
-    setDisplayText(scoreText);
-    
-    Serial.print("Correct! Score: ");
-    Serial.println(currentRound - 1);
-    Serial.print("Next round display time: ");
-    Serial.print(sequenceDisplayTime / 1000);
-    Serial.println(" seconds");
-    
-    currentState = STATE_RESULT;
-    displayStartTime = millis();
+void checkLockedDigit(int digit) {
+  // Compare as soon as a symbol is entered, a wrong one ends the game right away
+  int expected = gameSequence.get(inputPageStart + digit);
+  if (getIndexFromChar(playerInput[digit], ALPHA) != expected) {
+    game.post(EVENT_ROUND_LOST);
+    return;
+  }
+  
+  confirmedSymbols++;
+  roundMinimumCycles += min(expected, charSetSize - expected);  // Cycling starts from charSet[0]
+  if (confirmedSymbols < inputPageStart + inputPageLength) {
+    return;
+  }
+  
+  if (confirmedSymbols >= (int)gameSequence.length()) {
+    game.post(gameSequence.isFull() ? EVENT_SEQUENCE_COMPLETE : EVENT_ROUND_WON);
   }
   else {
-    playTone(toneError, toneDuration * 3);
-    setDisplayText(textError);
-    
-    Serial.println("Wrong! Game Over.");
-    Serial.print("Final Score: ");
-    Serial.println(currentRound - 1);
-    
-    currentState = STATE_RESULT;
-    displayStartTime = millis();
+    startInputPage(inputPageStart + inputPageLength);
+    Serial.print("Page done, next symbols from ");
+    Serial.println(inputPageStart + 1);
   }
 }
 
-void handleResult() {
-  unsigned long currentMillis = millis();
+void showMenuItem() {
+  setDisplayText(menuTexts[currentMenuItem]);
+}
+
+void scoreRound() {
+  buzzer.play(cueSuccess);
+  currentRound++;
   
-  if (currentMillis - displayStartTime >= resultDisplayTime) {
-    bool wasError = (currentDisplay[0] == 'E' && currentDisplay[1] == 'r' && currentDisplay[2] == 'r');
-    
-    if (!wasError && currentRound > 1) {
-      // Continue to next round
-      generateSequence();
-      currentState = STATE_SHOW_SEQUENCE;
-      displayStartTime = currentMillis;
-      setDisplayText(gameSequence);
-      
-      Serial.print("Round ");
-      Serial.print(currentRound);
-      Serial.println(" - Memorize the new sequence!");
+  char scoreText[5];
+  sprintf(scoreText, "%4d", currentRound - 1);
+  setDisplayText(scoreText);
+  
+  Serial.print("Correct! Score: ");
+  Serial.println(currentRound - 1);
+}
+
+// One EEPROM write batch per game: the profile (count and top table) and a log entry
+void saveGame() {
+  if (!gameUnsaved) {
+    return;
+  }
+  gameUnsaved = false;
+  
+  unsigned int score = currentRound - 1;
+  unsigned long average = (gameSymbolsEntered > 0) ? gameInputTime / gameSymbolsEntered : 0;
+  byte rank = records.recordGame(score, min(average, 0xFFFFUL), challengeCode);
+  
+  Serial.print("Saved: round ");
+  Serial.print(score);
+  Serial.print(", ");
+  Serial.print(average);
+  Serial.println(" ms per symbol");
+  if (rank != Records::NO_RANK) {
+    Serial.print("New top score, rank ");
+    Serial.println(rank + 1);
+  }
+}
+
+void printTopScores() {
+  Serial.println("Top scores (score, code):");
+  for (byte profile = 0; profile < profileCount; profile++) {
+    Records::Profile data;
+    records.readProfile(profile, data);
+    Serial.print(profile == records.getActiveProfile() ? "* " : "  ");
+    for (byte i = 0; i < Records::INITIALS; i++) {
+      Serial.print(data.initials[i]);
     }
-    else {
-      // Game over - return to menu
-      currentState = STATE_MENU;
-      currentMenuItem = MENU_PLAY;
-      setDisplayText(textPlay);
-      Serial.println("Game Over. Returning to menu...");
+    Serial.print(", ");
+    Serial.print(data.gamesPlayed);
+    Serial.print(" games:");
+    for (byte rank = 0; rank < topScoreCount && data.top[rank].score > 0; rank++) {
+      Serial.print(' ');
+      Serial.print(data.top[rank].score);
+      Serial.print(" (");
+      if (data.top[rank].code == Records::NO_CODE) {
+        Serial.print('-');
+      } else {
+        Serial.print(data.top[rank].code);
+      }
+      Serial.print(')');
     }
+    Serial.println();
   }
 }
 
-void handleShowPauseText() {
-  unsigned long currentMillis = millis();
-  
-  if (currentMillis - displayStartTime >= pauseTextDisplayTime) {
-    // Transition to pause menu
-    currentState = STATE_PAUSE;
-    setDisplayText(textPlay);  // Start with PLAY option in pause menu
-    currentMenuItem = MENU_PLAY;
-    Serial.println("Navigate menu to resume or quit.");
+void printGameLog() {
+  Serial.println("Recent games, newest first (player, round, ms per symbol, code):");
+  GameLogEntry entry;
+  for (byte age = 0; records.readLog(age, entry); age++) {
+    Records::Profile data;
+    records.readProfile(entry.profile, data);
+    Serial.print("  ");
+    for (byte i = 0; i < Records::INITIALS; i++) {
+      Serial.print(data.initials[i]);
+    }
+    Serial.print(", ");
+    Serial.print(entry.rounds);
+    Serial.print(", ");
+    Serial.print(entry.averageResponse);
+    Serial.print(", ");
+    Serial.println(entry.code);
+  }
+  if (records.getLogCount() == 0) {
+    Serial.println("  (none yet)");
   }
 }
 
-void handlePause() {
-  static unsigned long lastJoystickReading = 0;
-  unsigned long currentMillis = millis();
-  
-  // Navigate pause menu with joystick (same as main menu)
-  if (currentMillis - lastJoystickReading >= joystickDebounceTime) {
-    int joystickYValue = analogRead(JOYSTICK_Y_PIN);
-    
-    if (joystickYValue > joystickThresholdHigh) {
-      // Navigate down
-      currentMenuItem = (menuItem)((currentMenuItem + 1) % 3);
-      playTone(toneTick, toneDuration);
-      
-      switch (currentMenuItem) {
-        case MENU_PLAY:
-          setDisplayText(textPlay);
-          break;
-        case MENU_SCORE:
-          setDisplayText(textScore);
-          break;
-        case MENU_STOP:
-          setDisplayText(textStop);
-          break;
-      }
-      
-      lastJoystickReading = currentMillis;
+// One-letter queries, anything else is ignored
+void updateSerialCommands() {
+  while (Serial.available() > 0) {
+    char command = Serial.read();
+    if (command == 'l') {
+      printGameLog();
+    } else if (command == 't') {
+      printTopScores();
     }
-    else if (joystickYValue < joystickThresholdLow) {
-      // Navigate up
-      currentMenuItem = (menuItem)((currentMenuItem - 1 + 3) % 3);
-      playTone(toneTick, toneDuration);
-      
-      switch (currentMenuItem) {
-        case MENU_PLAY:
-          setDisplayText(textPlay);
-          break;
-        case MENU_SCORE:
-          setDisplayText(textScore);
-          break;
-        case MENU_STOP:
-          setDisplayText(textStop);
-          break;
-      }
-      
-      lastJoystickReading = currentMillis;
+  }
+}
+
+void printDwellTimes() {
+  Serial.println("Time per state (visits, total ms, longest ms):");
+  for (byte state = 0; state < STATE_COUNT; state++) {
+    const StateDwell& dwell = game.getDwell(state);
+    if (dwell.entries == 0) {
+      continue;
     }
+    Serial.print("  ");
+    Serial.print(state);
+    Serial.print(": ");
+    Serial.print(dwell.entries);
+    Serial.print(", ");
+    Serial.print(dwell.totalTime);
+    Serial.print(", ");
+    Serial.println(dwell.longestTime);
+  }
+}
+
+// Menu (main and pause)
+void enterMenu() {
+  if (currentMenuItem == MENU_STOP) {
+    currentMenuItem = MENU_PLAY;
+  }
+  showMenuItem();
+}
+
+void enterPause() {
+  currentMenuItem = MENU_PLAY;  // Start with PLAY option in pause menu
+  showMenuItem();
+  Serial.println("Navigate menu to resume or quit.");
+}
+
+void stepMenuItem(int step) {
+  do {
+    currentMenuItem = (menuItem)((currentMenuItem + step + MENU_ITEM_COUNT) % MENU_ITEM_COUNT);
+  } while ((currentMenuItem == MENU_CODE || currentMenuItem == MENU_PROFILE) &&
+           game.getState() == STATE_PAUSE);
+  buzzer.play(cueTick);
+  showMenuItem();
+}
+
+void selectNextMenuItem() {
+  stepMenuItem(1);
+}
+
+void selectPreviousMenuItem() {
+  stepMenuItem(-1);
+}
+
+void confirmMenuItem() {
+  buzzer.play(cueClick);
+  game.post(EVENT_MENU_PLAY + currentMenuItem);
+}
+
+unsigned int newChallengeCode() {
+  // ADC noise plus the moment PLAY was pressed
+  return Xorshift32::seedFromCode(entropyPool ^ micros()) % challengeCodeCount;
+}
+
+void startGame() {
+  challengeCode = newChallengeCode();
+  startChallenge();
+}
+
+void startChallenge() {
+  sequenceRandom.setSeed(Xorshift32::seedFromCode(challengeCode));
+  currentRound = 1;
+  gameSequence.clear();
+  for (byte symbol = 0; symbol < difficulty.getStartLength(); symbol++) {
+    extendSequence();
   }
+  game.resetDwell();
+  gameUnsaved = true;
+  gameInputTime = 0;
+  gameSymbolsEntered = 0;
+  Serial.print("Game started! Challenge code ");
+  Serial.print(challengeCode);
+  Serial.print(", difficulty level ");
+  Serial.println(difficulty.getLevel());
+  Serial.println("Memorize the sequence...");
+}
+
+void enterShowCode() {
+  char codeText[challengeCodeDigits + 1];
+  sprintf(codeText, "%04u", challengeCode);
+  setDisplayText(codeText);
+}
+
+// Challenge code entry (same cursor and cycling controls as the input phase,
+// over digits; long press plays the code)
+void enterCodeEntry() {
+  inputType = NUMBER;
+  inputPageLength = challengeCodeDigits;
+  cursorPosition = 0;
+  selectedDigitIndex = -1;
   
-  // Handle joystick button press in pause menu
-  if (digitalRead(JOYSTICK_BUTTON_PIN) == LOW && !joystickButtonPressed) {
-    joystickButtonPressed = true;
-    playTone(toneClick, toneDuration);
-    
-    switch (currentMenuItem) {
-      case MENU_PLAY:
-        // Resume game - return to showing sequence
-        Serial.println("Resuming game...");
-        currentState = STATE_SHOW_SEQUENCE;
-        displayStartTime = currentMillis;
-        setDisplayText(gameSequence);
-        break;
-        
-      case MENU_SCORE:
-        // Show high score
-        {
-          char scoreText[5];
-          sprintf(scoreText, "%4d", highScore);
-          setDisplayText(scoreText);
-          currentState = STATE_SHOW_SCORE;
-          displayStartTime = currentMillis;
-          Serial.print("High score: ");
-          Serial.println(highScore);
-        }
-        break;
-        
-      case MENU_STOP:
-        // Stop game and return to main menu
-        Serial.println("Game stopped. Returning to main menu...");
-        currentState = STATE_MENU;
-        currentMenuItem = MENU_PLAY;
-        setDisplayText(textPlay);
-        currentRound = 0;  // Reset game
-        break;
-    }
+  for (int digit = 0; digit < displayDigitsNumber; digit++) {
+    playerInput[digit] = (digit < challengeCodeDigits) ? numberSet[0] : ' ';
+    digitLocked[digit] = false;
   }
   
-  if (digitalRead(JOYSTICK_BUTTON_PIN) == HIGH) {
-    joystickButtonPressed = false;
+  setDisplayText(playerInput);
+  Serial.println("Enter a challenge code, long press to play it (pause button cancels).");
+}
+
+void clickEntryDigit() {
+  selectedDigitIndex = (selectedDigitIndex == -1) ? cursorPosition : -1;
+  buzzer.play(cueClick);
+}
+
+void confirmCode() {
+  challengeCode = 0;
+  for (int digit = 0; digit < challengeCodeDigits; digit++) {
+    challengeCode = challengeCode * 10 + getIndexFromChar(playerInput[digit], NUMBER);
   }
+  buzzer.play(cueConfirm);
+  game.post(EVENT_CODE_ENTERED);
 }
 
-void handleShowScore() {
-  unsigned long currentMillis = millis();
+void showHighScore() {
+  unsigned int highScore = records.getBestScore(records.getActiveProfile());
+  char scoreText[5];
+  // Scores are 16-bit now, the display still shows 4 digits
+  snprintf(scoreText, sizeof(scoreText), "%4u", highScore < 9999 ? highScore : 9999);
+  setDisplayText(scoreText);
+  Serial.print("High score: ");
+  Serial.println(highScore);
+}
+
+// Profiles: up/down browse, click plays as the shown one, long press edits
+// its initials with the code entry controls
+void showProfile() {
+  Records::Profile data;
+  records.readProfile(browsedProfile, data);
+  char profileText[displayDigitsNumber + 1];
+  for (byte i = 0; i < displayDigitsNumber; i++) {
+    profileText[i] = (i < Records::INITIALS) ? data.initials[i] : ' ';
+  }
+  profileText[displayDigitsNumber - 1] = numberSet[(browsedProfile + 1) % numberSetSize];
+  profileText[displayDigitsNumber] = '\0';
+  setDisplayText(profileText);
+}
+
+void browseProfiles() {
+  browsedProfile = records.getActiveProfile();
+}
+
+void enterProfileSelect() {
+  showProfile();
+  Serial.println("Up/down for a player, click to choose, long press to edit initials.");
+}
+
+void selectNextProfile() {
+  browsedProfile = (browsedProfile + 1) % profileCount;
+  buzzer.play(cueTick);
+  showProfile();
+}
+
+void selectPreviousProfile() {
+  browsedProfile = (browsedProfile + profileCount - 1) % profileCount;
+  buzzer.play(cueTick);
+  showProfile();
+}
+
+void chooseProfile() {
+  records.setActiveProfile(browsedProfile);
+  buzzer.play(cueClick);
+  Serial.print("Player ");
+  Serial.println(browsedProfile + 1);
+  game.post(EVENT_PROFILE_CHOSEN);
+}
+
+void enterInitialsEntry() {
+  Records::Profile data;
+  records.readProfile(browsedProfile, data);
   
-  if (currentMillis - displayStartTime >= scoreDisplayTime) {
-    currentState = STATE_MENU;
-    
-    if (currentMenuItem == MENU_STOP) {
-      currentMenuItem = MENU_PLAY;
-    }
-    
-    switch (currentMenuItem) {
-      case MENU_PLAY:
-        setDisplayText(textPlay);
-        break;
-      case MENU_SCORE:
-        setDisplayText(textScore);
-        break;
-      case MENU_STOP:
-        setDisplayText(textStop);
-        break;
-    }
-    
-    Serial.println("Returned to menu.");
+  inputType = ALPHA;
+  inputPageLength = Records::INITIALS;
+  cursorPosition = 0;
+  selectedDigitIndex = -1;
+  for (int digit = 0; digit < displayDigitsNumber; digit++) {
+    playerInput[digit] = (digit < Records::INITIALS) ? data.initials[digit] : ' ';
+    digitLocked[digit] = false;
   }
+  
+  setDisplayText(playerInput);
+  Serial.println("Enter initials, long press to save (pause button cancels).");
+}
+
+void confirmInitials() {
+  records.setInitials(browsedProfile, playerInput);
+  buzzer.play(cueConfirm);
+  game.post(EVENT_INITIALS_ENTERED);
+}
+
+void showStopText() {
+  setDisplayText(textStop);
+}
+
+void returnToMenu() {
+  Serial.println("Returned to menu.");
+}
+
+void resumeGame() {
+  Serial.println("Resuming game...");
+}
+
+void stopGame() {
+  Serial.println("Game stopped. Returning to main menu...");
+  saveGame();
+  currentRound = 0;  // Reset game
 }
 
-void playTone(int frequency, int duration) {
-  tone(BUZZER_PIN, frequency, duration);
+// Score from the pause menu ends the game like stop, so it is saved (and
+// counted in the score shown) before the menu comes back
+void stopGameShowScore() {
+  saveGame();
+  currentRound = 0;
+  showHighScore();
+}
+
+void enterShowPauseText() {
+  setDisplayText(textPause);
+  buzzer.play(cueClick);
+  Serial.println("Game paused...");
+}
+
+// Sequence playback, always from the first symbol (also when resuming)
+void enterShowSequence() {
+  playbackPageStart = 0;
+  playbackGap = false;
+  showSequencePage(0);
+  game.setTimeout(getPageTime(0));
+}
+
+void advancePlayback() {
+  if (playbackGap) {
+    playbackGap = false;
+    playbackPageStart += displayDigitsNumber;
+    showSequencePage(playbackPageStart);
+    game.setTimeout(getPageTime(playbackPageStart));
+  }
+  else if (playbackPageStart + displayDigitsNumber < (int)gameSequence.length()) {
+    // Blank briefly so two pages that look alike still read as separate
+    playbackGap = true;
+    setDisplayText("");
+    game.setTimeout(pageGapTime);
+  }
+  else {
+    game.post(EVENT_PLAYBACK_DONE);
+  }
+}
+
+// Input phase
+void enterInputPhase() {
+  inputType = ALPHA;
+  confirmedSymbols = 0;
+  inputStartTime = millis();
+  inputSeen = false;
+  roundCycles = 0;
+  roundMinimumCycles = 0;
+  startInputPage(0);
+  Serial.println("Your turn! Enter the sequence...");
+}
+
+void moveCursorLeft() {
+  // Only when no digit selected
+  if (selectedDigitIndex != -1) {
+    return;
+  }
+  cursorPosition = (cursorPosition - 1 + inputPageLength) % inputPageLength;
+  buzzer.play(cueTick);
+  Serial.print("Cursor at position: ");
+  Serial.println(cursorPosition);
+}
+
+void moveCursorRight() {
+  if (selectedDigitIndex != -1) {
+    return;
+  }
+  cursorPosition = (cursorPosition + 1) % inputPageLength;
+  buzzer.play(cueTick);
+  Serial.print("Cursor at position: ");
+  Serial.println(cursorPosition);
+}
+
+void cycleCharacterUp() {
+  // Only when digit selected
+  if (selectedDigitIndex == -1 || digitLocked[selectedDigitIndex]) {
+    return;
+  }
+  int setSize = (inputType == ALPHA) ? charSetSize : numberSetSize;
+  int currentIndex = getIndexFromChar(playerInput[selectedDigitIndex], inputType);
+  currentIndex = (currentIndex + 1) % setSize;
+  playerInput[selectedDigitIndex] = getCharFromIndex(currentIndex, inputType);
+  setDisplayText(playerInput);
+  roundCycles++;
+  buzzer.play(cueTick);
+}
+
+void cycleCharacterDown() {
+  if (selectedDigitIndex == -1 || digitLocked[selectedDigitIndex]) {
+    return;
+  }
+  int setSize = (inputType == ALPHA) ? charSetSize : numberSetSize;
+  int currentIndex = getIndexFromChar(playerInput[selectedDigitIndex], inputType);
+  currentIndex = (currentIndex - 1 + setSize) % setSize;
+  playerInput[selectedDigitIndex] = getCharFromIndex(currentIndex, inputType);
+  setDisplayText(playerInput);
+  roundCycles++;
+  buzzer.play(cueTick);
+}
+
+void clickDigit() {
+  if (selectedDigitIndex == -1 && !digitLocked[cursorPosition]) {
+    // Select digit (locked ones are already checked and stay as they are)
+    selectedDigitIndex = cursorPosition;
+    buzzer.play(cueClick);
+    Serial.print("Digit ");
+    Serial.print(selectedDigitIndex);
+    Serial.println(" selected. Use Up/Down to change character.");
+  }
+  else if (selectedDigitIndex == cursorPosition && !digitLocked[selectedDigitIndex]) {
+    // Lock digit, deselect and check it against the sequence
+    digitLocked[selectedDigitIndex] = true;
+    selectedDigitIndex = -1;
+    buzzer.play(cueClick);
+    Serial.print("Digit ");
+    Serial.print(cursorPosition);
+    Serial.println(" locked.");
+    checkLockedDigit(cursorPosition);
+  }
+}
+
+void submitAnswer() {
+  // Symbols are checked as they are locked, so an early submit can only be wrong
+  buzzer.play(cueConfirm);
+  Serial.println("Answer submitted!");
+  game.post(confirmedSymbols >= (int)gameSequence.length() ? EVENT_ROUND_WON : EVENT_ROUND_LOST);
+}
+
+// Round results
+void recordRound(bool won) {
+  RoundTelemetry round;
+  round.firstInputTime = inputSeen ? firstInputTime : millis() - inputStartTime;
+  round.submitTime = millis() - inputStartTime;
+  round.symbols = confirmedSymbols;
+  round.extraCycles = (roundCycles > roundMinimumCycles) ? roundCycles - roundMinimumCycles : 0;
+  difficulty.recordRound(won, round);
+  gameInputTime += round.submitTime;
+  gameSymbolsEntered += confirmedSymbols;
+  
+  Serial.print("Round stats: first input ");
+  Serial.print(round.firstInputTime);
+  Serial.print(" ms, answered in ");
+  Serial.print(round.submitTime);
+  Serial.print(" ms, ");
+  Serial.print(round.extraCycles);
+  Serial.println(" extra cycles");
+  Serial.print("Difficulty level ");
+  Serial.print(difficulty.getLevel());
+  Serial.print(": ");
+  Serial.print(difficulty.getSymbolTime());
+  Serial.print(" ms per symbol, games start with ");
+  Serial.print(difficulty.getStartLength());
+  Serial.print(" (");
+  Serial.print(difficulty.getSuccessPercent());
+  Serial.println("% of recent rounds won)");
+}
+
+void winRound() {
+  scoreRound();
+  recordRound(true);
+}
+
+void loseRound() {
+  buzzer.play(cueFailure);
+  setDisplayText(textError);
+  
+  Serial.println("Wrong! Game Over.");
+  Serial.print("Final Score: ");
+  Serial.println(currentRound - 1);
+  recordRound(false);
+  saveGame();
+}
+
+void completeSequence() {
+  scoreRound();
+  recordRound(true);
+  Serial.println("Sequence complete, nothing left to add. Game Over.");
+  saveGame();
+}
+
+void startNextRound() {
+  // One symbol longer (room is checked when the round is won)
+  extendSequence();
+  
+  Serial.print("Round ");
+  Serial.print(currentRound);
+  Serial.println(" - Memorize the sequence!");
+}
+
+void endGame() {
+  currentMenuItem = MENU_PLAY;
+  Serial.println("Game Over. Returning to menu...");
+  printDwellTimes();
 }
 
 int getIndexFromChar(char c, alphaOrNumber type) {
-  if (type == ALPHA) {
-    for (int i = 0; i < charSetSize; i++) {
-      if (charSet[i] == c) {
-        return i;
-      }
-    }
+  byte ascii = (byte)c;
+  if (ascii >= asciiTableSize) {
+    return 0;
   }
-  else if (type == NUMBER) {
-    for (int i = 0; i < numberSetSize; i++) {
-      if (numberSet[i] == c) {
-        return i;
-      }
-    }
+  
+  byte entry = pgm_read_byte(&asciiIndices[ascii]);
+  if (entry == asciiNotFound) {
+    return 0;
   }
   
-  return 0;
+  bool isNumber = (entry & asciiNumberFlag) != 0;
+  if (isNumber != (type == NUMBER)) {
+    return 0;
+  }
+  return entry & ~asciiNumberFlag;
 }
 
 char getCharFromIndex(int index, alphaOrNumber type) {
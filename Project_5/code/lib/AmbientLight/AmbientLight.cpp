@@ -0,0 +1,183 @@
+// AmbientLight.cpp
+#include "AmbientLight.hpp"
+
+// Result handed over by the conversion-complete interrupt
+static volatile unsigned int capturedReading = 0;
+static volatile bool captureReady = false;
+
+// Only our own conversions enable ADIE, so analogRead() users never land here
+ISR(ADC_vect) {
+    capturedReading = ADC;
+    captureReady = true;
+    ADCSRA &= ~_BV(ADIE);
+}
+
+AmbientLight::AmbientLight(byte photoPin) : sensorPin(photoPin) {
+    config = defaultConfig();
+
+    lastSampleTime = 0;
+    conversionPending = false;
+    filterPrimed = false;
+    filteredReading = 0;
+    referenceReading = 0;
+
+    targetLevel = config.maxBrightness;
+    currentLevel = config.maxBrightness;
+
+    rebuildCurve();
+}
+
+void AmbientLight::initialize() {
+    pinMode(sensorPin, INPUT);
+    startConversion();
+}
+
+AmbientLightConfig AmbientLight::defaultConfig() {
+    AmbientLightConfig defaults;
+    defaults.darkLevel = 250;
+    defaults.brightLevel = 350;
+    defaults.hysteresis = 20;
+    defaults.minBrightness = 0;
+    defaults.maxBrightness = 255;
+    defaults.gammaTenths = 22;
+    defaults.slewRate = 8;
+    defaults.smoothingShift = 3;
+    return defaults;
+}
+
+// Sampling (non-blocking: start now, the interrupt collects the result ~104us later)
+void AmbientLight::startConversion() {
+    byte channel = (sensorPin >= A0) ? sensorPin - A0 : sensorPin;
+
+    noInterrupts();
+    captureReady = false;
+    ADMUX = _BV(REFS0) | (channel & 0x07); // AVcc reference, same as analogRead()
+    ADCSRA |= _BV(ADIE) | _BV(ADSC);
+    interrupts();
+
+    conversionPending = true;
+    lastSampleTime = millis();
+}
+
+bool AmbientLight::takeSample(unsigned int& reading) {
+    if (!conversionPending) return false;
+
+    noInterrupts();
+    bool ready = captureReady;
+    reading = capturedReading;
+    captureReady = false;
+    interrupts();
+
+    if (ready) {
+        conversionPending = false;
+    }
+    return ready;
+}
+
+void AmbientLight::filterSample(unsigned int reading) {
+    unsigned int scaled = reading << 4;
+
+    if (!filterPrimed) {
+        filteredReading = scaled;
+        referenceReading = reading;
+        filterPrimed = true;
+        return;
+    }
+
+    // Exponential smoothing in x16 fixed point
+    int delta = (int)scaled - (int)filteredReading;
+    filteredReading += delta >> config.smoothingShift;
+
+    // Hysteresis: small wobbles around the reference don't move the target
+    unsigned int smoothed = filteredReading >> 4;
+    unsigned int difference = (smoothed > referenceReading) ? smoothed - referenceReading
+                                                            : referenceReading - smoothed;
+    if (difference > config.hysteresis) {
+        referenceReading = smoothed;
+    }
+}
+
+// Curve
+void AmbientLight::rebuildCurve() {
+    float gamma = config.gammaTenths / 10.0;
+    int range = (int)config.maxBrightness - (int)config.minBrightness;
+
+    for (byte i = 0; i < CURVE_POINTS; i++) {
+        float darkness = (float)i / (CURVE_POINTS - 1);
+        curve[i] = config.minBrightness + (byte)(range * pow(darkness, gamma) + 0.5);
+    }
+}
+
+byte AmbientLight::computeTarget() const {
+    // Darkness in 1/256 steps: 256 = at/below darkLevel, 0 = at/above brightLevel
+    unsigned int darkness;
+
+    if (referenceReading <= config.darkLevel) {
+        darkness = 256;
+    } else if (referenceReading >= config.brightLevel) {
+        darkness = 0;
+    } else {
+        darkness = ((unsigned long)(config.brightLevel - referenceReading) << 8) /
+                   (config.brightLevel - config.darkLevel);
+    }
+
+    // Linear interpolation between the 17 curve points
+    byte index = darkness >> 4;
+    byte fraction = darkness & 0x0F;
+    if (index >= CURVE_POINTS - 1) return curve[CURVE_POINTS - 1];
+
+    int low = curve[index];
+    int high = curve[index + 1];
+    return (byte)(low + (((high - low) * fraction) >> 4));
+}
+
+// Update Method
+void AmbientLight::update() {
+    unsigned int reading;
+    if (takeSample(reading)) {
+        filterSample(reading);
+        targetLevel = computeTarget();
+    }
+
+    if (!conversionPending && millis() - lastSampleTime >= SAMPLE_INTERVAL) {
+        startConversion();
+    }
+
+    // Slew-rate limited ramp towards the target
+    if (currentLevel < targetLevel) {
+        currentLevel = (targetLevel - currentLevel > config.slewRate) ?
+                       currentLevel + config.slewRate : targetLevel;
+    } else if (currentLevel > targetLevel) {
+        currentLevel = (currentLevel - targetLevel > config.slewRate) ?
+                       currentLevel - config.slewRate : targetLevel;
+    }
+}
+
+byte AmbientLight::getLevel() const {
+    return currentLevel;
+}
+
+unsigned int AmbientLight::getReading() const {
+    return filteredReading >> 4;
+}
+
+// Configuration
+const AmbientLightConfig& AmbientLight::getConfig() const {
+    return config;
+}
+
+void AmbientLight::setConfig(const AmbientLightConfig& newConfig) {
+    config = newConfig;
+
+    // Keep the curve well-formed whatever was typed in
+    if (config.brightLevel <= config.darkLevel) config.brightLevel = config.darkLevel + 1;
+    if (config.maxBrightness < config.minBrightness) config.maxBrightness = config.minBrightness;
+    if (config.gammaTenths == 0) config.gammaTenths = 10;
+    if (config.slewRate == 0) config.slewRate = 1;
+    if (config.smoothingShift > 6) config.smoothingShift = 6;
+
+    rebuildCurve();
+    if (filterPrimed) {
+        targetLevel = computeTarget();
+    }
+}
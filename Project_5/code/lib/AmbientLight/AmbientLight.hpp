@@ -0,0 +1,64 @@
+// AmbientLight.hpp
+#ifndef AMBIENT_LIGHT_HPP
+#define AMBIENT_LIGHT_HPP
+
+#include <Arduino.h>
+
+// Tunable Backlight Curve
+struct AmbientLightConfig {
+    unsigned int darkLevel;   // Photosensor reading at/below which the backlight is at maximum
+    unsigned int brightLevel; // Photosensor reading at/above which the backlight is at minimum
+    unsigned int hysteresis;  // Reading must move this much before the target changes
+    byte minBrightness;       // PWM level in bright surroundings
+    byte maxBrightness;       // PWM level in the dark
+    byte gammaTenths;         // Perceptual curve exponent x10 (22 = 2.2)
+    byte slewRate;            // Maximum PWM change per update
+    byte smoothingShift;      // Exponential smoothing weight = 1 / 2^shift
+};
+
+class AmbientLight {
+private:
+    const byte sensorPin;
+    AmbientLightConfig config;
+
+    // Sampling
+    unsigned long lastSampleTime;
+    const unsigned int SAMPLE_INTERVAL = 100; // Start a conversion every 100ms
+    bool conversionPending;
+    bool filterPrimed;
+    unsigned int filteredReading;  // Smoothed reading x16 (fixed point)
+    unsigned int referenceReading; // Last reading that moved the target (hysteresis)
+
+    // Output
+    static const byte CURVE_POINTS = 17;
+    byte curve[CURVE_POINTS];      // Gamma-corrected PWM levels, darkness 0..16
+    byte targetLevel;
+    byte currentLevel;
+
+    // Helper Methods
+    void startConversion();
+    bool takeSample(unsigned int& reading);
+    void filterSample(unsigned int reading);
+    byte computeTarget() const;
+    void rebuildCurve();
+
+public:
+    AmbientLight(byte photoPin);
+
+    // Initialization
+    void initialize();
+
+    // Update Method (call after every other analogRead user in the tick)
+    void update();
+
+    // Output
+    byte getLevel() const;
+    unsigned int getReading() const;
+
+    // Configuration
+    static AmbientLightConfig defaultConfig();
+    const AmbientLightConfig& getConfig() const;
+    void setConfig(const AmbientLightConfig& newConfig);
+};
+
+#endif // AMBIENT_LIGHT_HPP
@@ -0,0 +1,133 @@
+// ButtonEvents.cpp
+#include "ButtonEvents.hpp"
+
+ButtonEvents::ButtonEvents(byte numberOfButtons) {
+    buttonCount = (numberOfButtons > MAX_BUTTONS) ? MAX_BUTTONS : numberOfButtons;
+    handler = nullptr;
+
+    head = 0;
+    tail = 0;
+    droppedCount = 0;
+
+    debounceTime = 30;
+    longPressTime = 800;
+
+    for (byte i = 0; i < MAX_BUTTONS; i++) {
+        states[i].stablePressed = false;
+        states[i].rawPressed = false;
+        states[i].longPressSent = false;
+        states[i].lastAcceptTime = 0;
+        states[i].pressStartTime = 0;
+    }
+}
+
+void ButtonEvents::setHandler(ButtonEventHandler eventHandler) {
+    handler = eventHandler;
+}
+
+// ISR Side
+void ButtonEvents::push(byte button, bool pressed) {
+    byte next = (head + 1) & (QUEUE_SIZE - 1);
+    if (next == tail) {
+        droppedCount++;
+        return;
+    }
+
+    queue[head].button = button;
+    queue[head].pressed = pressed;
+    queue[head].timestamp = millis();
+    head = next; // Publish only after the record is complete
+}
+
+// Main Loop Side
+bool ButtonEvents::hasPending() const {
+    return head != tail;
+}
+
+void ButtonEvents::emit(byte button, ButtonEventType type, unsigned long timestamp,
+                        unsigned long heldTime) {
+    if (handler == nullptr) return;
+
+    ButtonEvent event;
+    event.button = button;
+    event.type = type;
+    event.timestamp = timestamp;
+    event.heldTime = heldTime;
+    handler(event);
+}
+
+void ButtonEvents::acceptEdge(byte button, bool pressed, unsigned long timestamp) {
+    ButtonState& state = states[button];
+    state.stablePressed = pressed;
+    state.lastAcceptTime = timestamp;
+
+    if (pressed) {
+        state.pressStartTime = timestamp;
+        state.longPressSent = false;
+        emit(button, BUTTON_PRESS, timestamp, 0);
+    } else {
+        emit(button, BUTTON_RELEASE, timestamp, timestamp - state.pressStartTime);
+    }
+}
+
+void ButtonEvents::processEdge(byte button, bool pressed, unsigned long timestamp) {
+    if (button >= buttonCount) return;
+
+    ButtonState& state = states[button];
+    state.rawPressed = pressed;
+
+    // Leading-edge debounce: react at once, then ignore chatter for debounceTime
+    if (pressed != state.stablePressed && timestamp - state.lastAcceptTime >= debounceTime) {
+        acceptEdge(button, pressed, timestamp);
+    }
+}
+
+void ButtonEvents::update() {
+    while (tail != head) {
+        byte index = tail;
+        byte button = queue[index].button;
+        bool pressed = queue[index].pressed;
+        unsigned long timestamp = queue[index].timestamp;
+        tail = (index + 1) & (QUEUE_SIZE - 1);
+
+        processEdge(button, pressed, timestamp);
+    }
+
+    unsigned long currentTime = millis();
+
+    for (byte i = 0; i < buttonCount; i++) {
+        ButtonState& state = states[i];
+
+        // An edge swallowed by the debounce window still counts once the pin settles
+        if (state.rawPressed != state.stablePressed &&
+            currentTime - state.lastAcceptTime >= debounceTime) {
+            acceptEdge(i, state.rawPressed, currentTime);
+        }
+
+        if (state.stablePressed && !state.longPressSent &&
+            currentTime - state.pressStartTime >= longPressTime) {
+            state.longPressSent = true;
+            emit(i, BUTTON_LONG_PRESS, currentTime, currentTime - state.pressStartTime);
+        }
+    }
+}
+
+bool ButtonEvents::isPressed(byte button) const {
+    return (button < buttonCount) ? states[button].stablePressed : false;
+}
+
+unsigned int ButtonEvents::getDroppedCount() const {
+    noInterrupts();
+    unsigned int count = droppedCount;
+    interrupts();
+    return count;
+}
+
+// Tunable Settings
+unsigned int& ButtonEvents::getDebounceTime() {
+    return debounceTime;
+}
+
+unsigned int& ButtonEvents::getLongPressTime() {
+    return longPressTime;
+}
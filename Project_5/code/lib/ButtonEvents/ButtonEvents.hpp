@@ -0,0 +1,83 @@
+// ButtonEvents.hpp
+#ifndef BUTTON_EVENTS_HPP
+#define BUTTON_EVENTS_HPP
+
+#include <Arduino.h>
+
+// Debounced Event Types
+enum ButtonEventType {
+    BUTTON_PRESS,
+    BUTTON_RELEASE,
+    BUTTON_LONG_PRESS
+};
+
+struct ButtonEvent {
+    byte button;
+    ButtonEventType type;
+    unsigned long timestamp; // millis() of the edge that caused it
+    unsigned long heldTime;  // ms held, for releases and long presses
+};
+
+typedef void (*ButtonEventHandler)(const ButtonEvent& event);
+
+// Raw edge as recorded by the interrupt
+struct ButtonEdge {
+    byte button;
+    bool pressed;
+    unsigned long timestamp;
+};
+
+// Per-button debounce state (owned by the main loop)
+struct ButtonState {
+    bool stablePressed;
+    bool rawPressed;
+    bool longPressSent;
+    unsigned long lastAcceptTime;
+    unsigned long pressStartTime;
+};
+
+// Timestamped edge queue fed by pin-change ISRs and drained by loop().
+// The ring has a single producer side (AVR interrupts don't nest, so every
+// button ISR pushes in turn) and a single consumer, so it needs no locking.
+class ButtonEvents {
+private:
+    static const byte MAX_BUTTONS = 4;
+    static const byte QUEUE_SIZE = 16; // Power of two
+
+    volatile ButtonEdge queue[QUEUE_SIZE];
+    volatile byte head; // Written by the ISR
+    volatile byte tail; // Written by the main loop
+    volatile unsigned int droppedCount;
+
+    ButtonState states[MAX_BUTTONS];
+    byte buttonCount;
+    ButtonEventHandler handler;
+
+    unsigned int debounceTime;
+    unsigned int longPressTime;
+
+    void processEdge(byte button, bool pressed, unsigned long timestamp);
+    void acceptEdge(byte button, bool pressed, unsigned long timestamp);
+    void emit(byte button, ButtonEventType type, unsigned long timestamp, unsigned long heldTime);
+
+public:
+    ButtonEvents(byte numberOfButtons);
+
+    void setHandler(ButtonEventHandler eventHandler);
+
+    // ISR Side (call with the pin level read inside the ISR)
+    void push(byte button, bool pressed);
+
+    // Main Loop Side
+    bool hasPending() const;
+    void update(); // Drain the queue, debounce, detect long presses
+
+    bool isPressed(byte button) const;
+    unsigned int getDroppedCount() const;
+
+    // Tunable Settings
+    unsigned int& getDebounceTime();
+    unsigned int& getLongPressTime();
+};
+
+#endif // BUTTON_EVENTS_HPP
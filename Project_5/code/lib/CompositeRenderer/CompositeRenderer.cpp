@@ -0,0 +1,185 @@
+// CompositeRenderer.cpp
+#include "CompositeRenderer.hpp"
+
+CompositeRenderer::CompositeRenderer() {
+    targetCount = 0;
+    beginFrame(FRAME_NONE);
+}
+
+bool CompositeRenderer::addRenderer(IRenderer* renderer, unsigned int frameInterval) {
+    if (renderer == nullptr || targetCount >= MAX_TARGETS) return false;
+
+    RenderTarget& target = targets[targetCount++];
+    target.renderer = renderer;
+    target.frameInterval = frameInterval;
+    target.lastFrameTime = 0;
+    target.lastSignature = 0;
+    target.hasFrame = false;
+    return true;
+}
+
+byte CompositeRenderer::getRendererCount() const {
+    return targetCount;
+}
+
+// Frame Capture
+void CompositeRenderer::beginFrame(FrameType type) {
+    frame.type = type;
+    frame.selectedOption = START_GAME;
+    frame.highscores = nullptr;
+    frame.room = nullptr;
+    frame.player.column = 0;
+    frame.player.row = 0;
+    frame.player.isAlive = false;
+    frame.score = 0;
+    frame.roomNumber = 0;
+    frame.isNewHighscore = false;
+    frame.timeRemaining = 0;
+}
+
+// 16-bit FNV-1a over everything a renderer could draw from this frame
+static unsigned int hashBytes(unsigned int hash, const void* data, byte length) {
+    const byte* bytes = (const byte*)data;
+    for (byte i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x0193;
+    }
+    return hash;
+}
+
+unsigned int CompositeRenderer::calculateSignature() const {
+    unsigned int hash = 0x9DC5;
+
+    hash = hashBytes(hash, &frame.type, sizeof(frame.type));
+    hash = hashBytes(hash, &frame.selectedOption, sizeof(frame.selectedOption));
+    hash = hashBytes(hash, &frame.player, sizeof(frame.player));
+    hash = hashBytes(hash, &frame.score, sizeof(frame.score));
+    hash = hashBytes(hash, &frame.roomNumber, sizeof(frame.roomNumber));
+    hash = hashBytes(hash, &frame.isNewHighscore, sizeof(frame.isNewHighscore));
+    hash = hashBytes(hash, &frame.timeRemaining, sizeof(frame.timeRemaining));
+
+    if (frame.highscores != nullptr) {
+        hash = hashBytes(hash, frame.highscores, HIGHSCORE_COUNT * sizeof(unsigned int));
+    }
+    if (frame.room != nullptr) {
+        hash = hashBytes(hash, frame.room->topRow, 16);
+        hash = hashBytes(hash, frame.room->bottomRow, 16);
+    }
+    return hash;
+}
+
+// Frame Dispatch
+void CompositeRenderer::drawFrame(IRenderer* renderer) const {
+    switch (frame.type) {
+        case FRAME_MENU:
+            renderer->renderMenu(frame.selectedOption, frame.highscores);
+            break;
+        case FRAME_GAME:
+            renderer->renderGame(*frame.room, frame.player, frame.score, frame.roomNumber);
+            break;
+        case FRAME_PAUSE:
+            renderer->renderPause();
+            break;
+        case FRAME_GAME_OVER:
+            renderer->renderGameOver(frame.score, frame.isNewHighscore);
+            break;
+        case FRAME_VICTORY:
+            renderer->renderVictory(frame.score, frame.isNewHighscore);
+            break;
+        case FRAME_ROOM_CLEAR:
+            renderer->renderRoomClear(frame.roomNumber, frame.score);
+            break;
+        case FRAME_RESPAWN:
+            renderer->renderRespawnMessage(frame.timeRemaining);
+            break;
+        case FRAME_NONE:
+            break;
+    }
+}
+
+void CompositeRenderer::dispatchFrame() {
+    unsigned long currentTime = millis();
+    unsigned int signature = calculateSignature();
+
+    for (byte i = 0; i < targetCount; i++) {
+        RenderTarget& target = targets[i];
+
+        if (target.hasFrame && target.lastSignature == signature) continue;
+        if (target.hasFrame && currentTime - target.lastFrameTime < target.frameInterval) continue;
+
+        drawFrame(target.renderer);
+        target.lastFrameTime = currentTime;
+        target.lastSignature = signature;
+        target.hasFrame = true;
+    }
+}
+
+// IRenderer Interface Implementation
+void CompositeRenderer::initialize() {
+    for (byte i = 0; i < targetCount; i++) {
+        targets[i].renderer->initialize();
+    }
+}
+
+void CompositeRenderer::clear() {
+    for (byte i = 0; i < targetCount; i++) {
+        targets[i].renderer->clear();
+        targets[i].hasFrame = false; // Next frame is drawn regardless of content
+    }
+}
+
+void CompositeRenderer::renderMenu(MenuOption selectedOption, const unsigned int* highscores) {
+    beginFrame(FRAME_MENU);
+    frame.selectedOption = selectedOption;
+    frame.highscores = highscores;
+    dispatchFrame();
+}
+
+void CompositeRenderer::renderGame(const Room& currentRoom, const Player& player, 
+                                   unsigned int score, byte roomNumber) {
+    beginFrame(FRAME_GAME);
+    frame.room = &currentRoom;
+    frame.player = player;
+    frame.score = score;
+    frame.roomNumber = roomNumber;
+    dispatchFrame();
+}
+
+void CompositeRenderer::renderPause() {
+    beginFrame(FRAME_PAUSE);
+    dispatchFrame();
+}
+
+void CompositeRenderer::renderGameOver(unsigned int finalScore, bool isNewHighscore) {
+    beginFrame(FRAME_GAME_OVER);
+    frame.score = finalScore;
+    frame.isNewHighscore = isNewHighscore;
+    dispatchFrame();
+}
+
+void CompositeRenderer::renderVictory(unsigned int finalScore, bool isNewHighscore) {
+    beginFrame(FRAME_VICTORY);
+    frame.score = finalScore;
+    frame.isNewHighscore = isNewHighscore;
+    dispatchFrame();
+}
+
+void CompositeRenderer::renderRoomClear(byte roomNumber, unsigned int score) {
+    beginFrame(FRAME_ROOM_CLEAR);
+    frame.roomNumber = roomNumber;
+    frame.score = score;
+    dispatchFrame();
+}
+
+void CompositeRenderer::renderRespawnMessage(unsigned int timeRemaining) {
+    beginFrame(FRAME_RESPAWN);
+    frame.timeRemaining = timeRemaining;
+    dispatchFrame();
+}
+
+void CompositeRenderer::update() {
+    // Scrolling and other animations run at the caller's rate for every child
+    for (byte i = 0; i < targetCount; i++) {
+        targets[i].renderer->update();
+    }
+}
@@ -0,0 +1,80 @@
+// CompositeRenderer.hpp
+#ifndef COMPOSITE_RENDERER_HPP
+#define COMPOSITE_RENDERER_HPP
+
+#include "IRenderer.hpp"
+
+// Which screen a captured frame describes
+enum FrameType {
+    FRAME_NONE,
+    FRAME_MENU,
+    FRAME_GAME,
+    FRAME_PAUSE,
+    FRAME_GAME_OVER,
+    FRAME_VICTORY,
+    FRAME_ROOM_CLEAR,
+    FRAME_RESPAWN
+};
+
+// Snapshot of one render call, captured once and replayed to every child
+struct RenderFrame {
+    FrameType type;
+    MenuOption selectedOption;
+    const unsigned int* highscores;
+    const Room* room;
+    Player player;
+    unsigned int score;
+    byte roomNumber;
+    bool isNewHighscore;
+    unsigned int timeRemaining;
+};
+
+// Child renderer with its own frame rate
+struct RenderTarget {
+    IRenderer* renderer;
+    unsigned int frameInterval;
+    unsigned long lastFrameTime;
+    unsigned int lastSignature;
+    bool hasFrame;
+};
+
+// Fans every frame out to several renderers, each throttled independently
+// and skipped entirely when the frame hasn't changed since it last drew
+class CompositeRenderer : public IRenderer {
+private:
+    static const byte MAX_TARGETS = 4;
+    static const byte HIGHSCORE_COUNT = 3;
+
+    RenderTarget targets[MAX_TARGETS];
+    byte targetCount;
+
+    RenderFrame frame;
+
+    // Helper Methods
+    void beginFrame(FrameType type);
+    unsigned int calculateSignature() const;
+    void dispatchFrame();
+    void drawFrame(IRenderer* renderer) const;
+
+public:
+    CompositeRenderer();
+
+    // Children (interval 0 = draw every frame that changed)
+    bool addRenderer(IRenderer* renderer, unsigned int frameInterval);
+    byte getRendererCount() const;
+
+    // IRenderer Interface Implementation
+    void initialize() override;
+    void clear() override;
+    void renderMenu(MenuOption selectedOption, const unsigned int* highscores) override;
+    void renderGame(const Room& currentRoom, const Player& player, 
+                   unsigned int score, byte roomNumber) override;
+    void renderPause() override;
+    void renderGameOver(unsigned int finalScore, bool isNewHighscore) override;
+    void renderVictory(unsigned int finalScore, bool isNewHighscore) override;
+    void renderRoomClear(byte roomNumber, unsigned int score) override;
+    void renderRespawnMessage(unsigned int timeRemaining) override;
+    void update() override;
+};
+
+#endif // COMPOSITE_RENDERER_HPP
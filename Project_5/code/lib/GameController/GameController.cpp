@@ -4,6 +4,7 @@
 GameController::GameController(GameModel& gameModel, HardwareManager& hwManager,
                                byte joyXPin, byte joyYPin)
     : model(gameModel), hardware(hwManager),
+      saveState(SAVE_STATE_EEPROM_ADDRESS),
       joystickXPin(joyXPin), joystickYPin(joyYPin) {
     
     lastInputTime = 0;
@@ -12,6 +13,7 @@ GameController::GameController(GameModel& gameModel, HardwareManager& hwManager,
     roomClearMessageShown = false;
     roomClearTime = 0;
     lastUpdateTime = 0;
+    updateInterval = 50;
 }
 
 void GameController::initialize() {
@@ -23,14 +25,17 @@ void GameController::initialize() {
     
     // Load highscores from EEPROM
     model.loadHighscoresFromEEPROM(0);
+    
+    // Pick up where the last session left off
+    resumeSavedGame();
 }
 
 // Input Reading Methods
-int GameController::readJoystickX() {
+unsigned int GameController::readJoystickX() {
     return analogRead(joystickXPin);
 }
 
-int GameController::readJoystickY() {
+unsigned int GameController::readJoystickY() {
     return analogRead(joystickYPin);
 }
 
@@ -86,6 +91,8 @@ void GameController::updatePausedState() {
 }
 
 void GameController::updateGameOverState() {
+    discardSavedGame();
+    
     // Check if score is a new highscore
     if (model.isNewHighscore(model.getScore())) {
         model.addHighscore(model.getScore());
@@ -161,9 +168,11 @@ void GameController::checkRoomCompletion() {
         if (model.isGameCompleted()) {
             model.setVictory();
             hardware.playSound(SOUND_VICTORY);
+            discardSavedGame();
         } else {
             model.advanceToNextRoom();
             roomClearMessageShown = false;
+            saveGame();
         }
     }
 }
@@ -175,19 +184,61 @@ void GameController::handleRespawn() {
     }
 }
 
+// Save-State Helpers
+void GameController::saveGame() {
+    GameSnapshot snapshot;
+    model.captureSnapshot(snapshot);
+    saveState.save(snapshot);
+    
+    Serial.print(F("Game saved ("));
+    Serial.print(SaveState::getSnapshotSize());
+    Serial.print(F(" bytes, "));
+    Serial.print(saveState.getLastWriteMicros());
+    Serial.println(F(" us)"));
+}
+
+void GameController::discardSavedGame() {
+    if (!saveState.hasSnapshot()) return;
+    
+    saveState.invalidate();
+    Serial.println(F("Saved game discarded"));
+}
+
+bool GameController::resumeSavedGame() {
+    unsigned long startTime = micros();
+    
+    saveState.initialize();
+    
+    GameSnapshot snapshot;
+    if (!saveState.load(snapshot)) return false;
+    
+    if (!model.restoreSnapshot(snapshot)) {
+        discardSavedGame();
+        return false;
+    }
+    
+    // Resume paused so the player gets their bearings first
+    model.setState(PAUSED);
+    lastInputTime = millis();
+    
+    Serial.print(F("Resumed saved game in room "));
+    Serial.print(snapshot.roomIndex + 1);
+    Serial.print(F(" ("));
+    Serial.print(micros() - startTime);
+    Serial.println(F(" us)"));
+    return true;
+}
+
 // Main Update Loop
 void GameController::update() {
     unsigned long currentTime = millis();
     
-    // Throttle updates to UPDATE_INTERVAL
-    if (currentTime - lastUpdateTime < UPDATE_INTERVAL) {
+    // Throttle updates to updateInterval
+    if (currentTime - lastUpdateTime < updateInterval) {
         return;
     }
     lastUpdateTime = currentTime;
     
-    // Update hardware (backlight, LEDs, buzzer)
-    hardware.update(model.getState());
-    
     // Update game logic based on current state
     switch (model.getState()) {
         case MENU:
@@ -210,6 +261,14 @@ void GameController::update() {
             updateVictoryState();
             break;
     }
+    
+    // Update hardware (backlight, LEDs, buzzer) after the joystick reads, so the
+    // background photosensor conversion never overlaps an analogRead()
+    hardware.update(model.getState());
+}
+
+unsigned long GameController::getNextUpdateTime() const {
+    return lastUpdateTime + updateInterval;
 }
 
 // External Input Handlers (called by ISRs via volatile flags)
@@ -218,6 +277,9 @@ void GameController::handleSelectButton() {
         case MENU:
             model.confirmMenuSelection();
             hardware.playSound(SOUND_MENU_SELECT);
+            if (model.getState() == PLAYING) {
+                discardSavedGame(); // A fresh game replaces the old save
+            }
             break;
             
         case GAME_OVER:
@@ -236,6 +298,7 @@ void GameController::handlePauseButton() {
         case PLAYING:
             model.setState(PAUSED);
             hardware.playSound(SOUND_MENU_SELECT);
+            saveGame();
             break;
             
         case PAUSED:
@@ -251,3 +314,12 @@ void GameController::handlePauseButton() {
 bool GameController::isWaitingForRespawn() const {
     return waitingForRespawn;
 }
+
+// Tunable Settings
+InputConfig& GameController::getInputConfig() {
+    return inputConfig;
+}
+
+unsigned int& GameController::getUpdateInterval() {
+    return updateInterval;
+}
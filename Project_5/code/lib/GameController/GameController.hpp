@@ -5,14 +5,15 @@
 #include <Arduino.h>
 #include "GameModel.hpp"
 #include "HardwareManager.hpp"
+#include "SaveState.hpp"
 
-// Input Configuration
+// Input Configuration (tunable at runtime through the serial shell)
 struct InputConfig {
-    const int joystickDeadzoneMin = 400;
-    const int joystickDeadzoneMax = 600;
-    const int joystickThreshold = 700;
-    const unsigned int debouncingDelay = 200; // ms between inputs
-    const unsigned int respawnDelay = 2000; // 2 seconds respawn delay
+    unsigned int joystickDeadzoneMin = 400;
+    unsigned int joystickDeadzoneMax = 600;
+    unsigned int joystickThreshold = 700;
+    unsigned int debouncingDelay = 200; // ms between inputs
+    unsigned int respawnDelay = 2000; // 2 seconds respawn delay
 };
 
 class GameController {
@@ -21,6 +22,10 @@ private:
     HardwareManager& hardware;
     InputConfig inputConfig;
     
+    // Save-State (EEPROM 128+, clear of highscores and parameters)
+    static const int SAVE_STATE_EEPROM_ADDRESS = 128;
+    SaveState saveState;
+    
     // Pin References
     const byte joystickXPin;
     const byte joystickYPin;
@@ -37,11 +42,11 @@ private:
     
     // Game Update Timing
     unsigned long lastUpdateTime;
-    const unsigned int UPDATE_INTERVAL = 50; // 50ms = 20 updates/sec
+    unsigned int updateInterval; // Default 50ms = 20 updates/sec
     
     // Input Handling Methods
-    int readJoystickX();
-    int readJoystickY();
+    unsigned int readJoystickX();
+    unsigned int readJoystickY();
     bool isJoystickLeft();
     bool isJoystickRight();
     bool isJoystickUp();
@@ -61,6 +66,11 @@ private:
     void checkRoomCompletion();
     void handleRespawn();
     
+    // Save-State Helpers
+    void saveGame();
+    void discardSavedGame();
+    bool resumeSavedGame();
+    
 public:
     GameController(GameModel& gameModel, HardwareManager& hwManager,
                    byte joyXPin, byte joyYPin);
@@ -70,6 +80,7 @@ public:
     
     // Main Update Loop
     void update();
+    unsigned long getNextUpdateTime() const;
     
     // External Input Handlers (called by ISRs)
     void handleSelectButton();
@@ -77,6 +88,10 @@ public:
     
     // Getters
     bool isWaitingForRespawn() const;
+    
+    // Tunable Settings
+    InputConfig& getInputConfig();
+    unsigned int& getUpdateInterval();
 };
 
 #endif // GAME_CONTROLLER_H
@@ -67,6 +67,7 @@ void GameModel::loadRoom(byte roomIndex, const char* topRowData, const char* bot
     // Count cups in this room
     rooms[roomIndex].cupsInRoom = countCupsInRoom(roomIndex);
     rooms[roomIndex].cupsCollected = 0;
+    rooms[roomIndex].collectedCupMask = 0;
 }
 
 
@@ -150,6 +151,7 @@ void GameModel::startNewGame() {
     // Reset all rooms
     for (byte i = 0; i < TOTAL_ROOMS; i++) {
         rooms[i].cupsCollected = 0;
+        rooms[i].collectedCupMask = 0;
     }
     
     resetPlayerToRoomStart();
@@ -253,6 +255,7 @@ bool GameModel::collectCupAt(byte column, byte row) {
     if (rowData[column] == '3') {
         rowData[column] = ' ';
         rooms[currentRoomIndex].cupsCollected++;
+        rooms[currentRoomIndex].collectedCupMask |= 1UL << (row * 16 + column);
         addScore(POINTS_PER_CUP);
         return true;
     }
@@ -414,4 +417,54 @@ void GameModel::setVictory() {
 
 void GameModel::setGameOver() {
     currentState = GAME_OVER;
-}
\ No newline at end of file
+}
+
+// Save-State
+void GameModel::captureSnapshot(GameSnapshot& snapshot) const {
+    snapshot.version = SNAPSHOT_VERSION;
+    snapshot.roomIndex = currentRoomIndex;
+    snapshot.collectedCupMask = rooms[currentRoomIndex].collectedCupMask;
+    snapshot.playerColumn = player.column;
+    snapshot.playerRow = player.row;
+    snapshot.playerAlive = player.isAlive;
+    snapshot.score = score;
+    snapshot.roomElapsedTime = millis() - roomStartTime;
+}
+
+bool GameModel::restoreSnapshot(const GameSnapshot& snapshot) {
+    if (snapshot.version != SNAPSHOT_VERSION) return false;
+    if (snapshot.roomIndex >= TOTAL_ROOMS) return false;
+    if (snapshot.playerColumn >= 16 || snapshot.playerRow >= 2) return false;
+    
+    // Every collected cup must still be a cup in the untouched room layout
+    Room& room = rooms[snapshot.roomIndex];
+    for (byte cell = 0; cell < 32; cell++) {
+        if (!(snapshot.collectedCupMask & (1UL << cell))) continue;
+        
+        const char* rowData = (cell < 16) ? room.topRow : room.bottomRow;
+        if (rowData[cell % 16] != '3') return false;
+    }
+    
+    startNewGame();
+    currentRoomIndex = snapshot.roomIndex;
+    resetPlayerToRoomStart(); // Clears the 'P' marker from the room
+    
+    // Remove the cups that were already collected
+    for (byte cell = 0; cell < 32; cell++) {
+        if (!(snapshot.collectedCupMask & (1UL << cell))) continue;
+        
+        char* rowData = (cell < 16) ? room.topRow : room.bottomRow;
+        rowData[cell % 16] = ' ';
+        room.cupsCollected++;
+    }
+    room.collectedCupMask = snapshot.collectedCupMask;
+    
+    if (snapshot.playerAlive) {
+        player.column = snapshot.playerColumn;
+        player.row = snapshot.playerRow;
+    }
+    
+    score = snapshot.score;
+    roomStartTime = millis() - snapshot.roomElapsedTime;
+    return true;
+}
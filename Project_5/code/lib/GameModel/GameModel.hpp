@@ -49,6 +49,21 @@ struct Room {
     char bottomRow[17]; // 16 chars + null terminator
     byte cupsInRoom;
     byte cupsCollected;
+    unsigned long collectedCupMask; // Bit (row * 16 + column) set per collected cup
+};
+
+// Save-State Snapshot (everything needed to resume a game in progress)
+const byte SNAPSHOT_VERSION = 1;
+
+struct GameSnapshot {
+    byte version;
+    byte roomIndex;
+    unsigned long collectedCupMask;
+    byte playerColumn;
+    byte playerRow;
+    bool playerAlive;
+    unsigned int score;
+    unsigned long roomElapsedTime; // ms spent in the current room
 };
 
 class GameModel {
@@ -138,6 +153,10 @@ public:
     // Victory/Defeat
     void setVictory();
     void setGameOver();
+    
+    // Save-State
+    void captureSnapshot(GameSnapshot& snapshot) const;
+    bool restoreSnapshot(const GameSnapshot& snapshot); // false if it doesn't fit this game
 };
 
 #endif // GAME_MODEL_H
@@ -23,28 +23,33 @@ const MelodyNote HardwareManager::gameOverMelody[] = {
     {400, 200}, {350, 200}, {300, 200}, {250, 400}
 };
 
+// Define Static LED Effects
+const Keyframe HardwareManager::fastBlinkEffect[] = {
+    {255, 100, EASE_STEP}, {0, 100, EASE_STEP}
+};
+
+const Keyframe HardwareManager::slowBlinkEffect[] = {
+    {255, 200, EASE_STEP}, {0, 200, EASE_STEP}
+};
+
+const Keyframe HardwareManager::breatheEffect[] = {
+    {255, 500, EASE_OUT}, {0, 500, EASE_IN}
+};
+
 HardwareManager::HardwareManager(byte photoPin, byte backlightPin, byte defeatPin, 
                                  byte winPin, byte bonusPin, byte buzzerPin)
     : photosensorPin(photoPin), backlightPin(backlightPin), 
       defeatLightPin(defeatPin), winLightPin(winPin), 
-      bonusLightPin(bonusPin), buzzerPin(buzzerPin) {
+      bonusLightPin(bonusPin), buzzerPin(buzzerPin),
+      ambientLight(photoPin),
+      ledEffects(defeatPin, winPin, bonusPin, backlightPin) {
     
-    lastBacklightCheckTime = 0;
+    backlightLevel = 255;
     backlightState = true;
     autoBacklightEnabled = true;
     
-    ledBlinkStartTime = 0;
-    ledBlinkDuration = 0;
-    ledBlinkInterval = 0;
-    ledBlinkCount = 0;
-    ledBlinkMaxCount = 0;
-    ledBlinkPin = 0;
-    ledBlinkActive = false;
-    ledBlinkState = false;
-    lastLEDToggleTime = 0;
-    
-    multiLedBlinkActive = false;
-    multiLedPinCount = 0;
+    lastStatusState = MENU;
+    statusLEDsInitialized = false;
     
     buzzerEnabled = true;
     currentSound = SOUND_NONE;
@@ -56,16 +61,16 @@ HardwareManager::HardwareManager(byte photoPin, byte backlightPin, byte defeatPi
 }
 
 void HardwareManager::initialize() {
-    pinMode(photosensorPin, INPUT);
-    pinMode(backlightPin, OUTPUT);
-    pinMode(defeatLightPin, OUTPUT);
-    pinMode(winLightPin, OUTPUT);
-    pinMode(bonusLightPin, OUTPUT);
     pinMode(buzzerPin, OUTPUT);
+    ambientLight.initialize();
+    
+    // Status LEDs and backlight are driven by the effect engine
+    ledEffects.initialize();
     
     // Initial states
-    digitalWrite(backlightPin, HIGH);
-    turnOffAllLEDs();
+    setBacklight(true);
+    setStatusLevels(0, 0, 0);
+    ledEffects.update();
     noTone(buzzerPin);
 }
 
@@ -73,19 +78,14 @@ void HardwareManager::initialize() {
 void HardwareManager::updateBacklight() {
     if (!autoBacklightEnabled) return;
     
-    unsigned long currentTime = millis();
-    if (currentTime - lastBacklightCheckTime >= BACKLIGHT_CHECK_INTERVAL) {
-        int brightness = analogRead(photosensorPin);
-        
-        // If it's dark, turn backlight ON; if bright, turn OFF
-        bool shouldBeOn = (brightness < BRIGHTNESS_THRESHOLD);
-        
-        if (shouldBeOn != backlightState) {
-            backlightState = shouldBeOn;
-            digitalWrite(backlightPin, backlightState ? HIGH : LOW);
-        }
-        
-        lastBacklightCheckTime = currentTime;
+    // Smoothed, hysteretic and slew-limited; only push the level when it moves
+    ambientLight.update();
+    byte level = ambientLight.getLevel();
+    
+    if (level != backlightLevel) {
+        backlightLevel = level;
+        backlightState = (level > 0);
+        ledEffects.setLevel(LED_BACKLIGHT, LAYER_BASE, level);
     }
 }
 
@@ -103,141 +103,76 @@ bool HardwareManager::getAutoBacklight() const {
 
 void HardwareManager::setBacklight(bool on) {
     backlightState = on;
-    digitalWrite(backlightPin, on ? HIGH : LOW);
+    backlightLevel = on ? 255 : 0;
+    ledEffects.setLevel(LED_BACKLIGHT, LAYER_BASE, backlightLevel);
 }
 
-// LED Management Helper Methods
-void HardwareManager::turnOffAllLEDs() {
-    digitalWrite(defeatLightPin, LOW);
-    digitalWrite(winLightPin, LOW);
-    digitalWrite(bonusLightPin, LOW);
+byte HardwareManager::getBacklightLevel() const {
+    return backlightLevel;
 }
 
-void HardwareManager::startLEDBlink(byte pin, byte count, unsigned int interval) {
-    ledBlinkPin = pin;
-    ledBlinkMaxCount = count;
-    ledBlinkCount = 0;
-    ledBlinkInterval = interval;
-    ledBlinkActive = true;
-    ledBlinkState = false;
-    ledBlinkStartTime = millis();
-    lastLEDToggleTime = millis();
-    
-    multiLedBlinkActive = false; // Disable multi-LED if single LED starts
+unsigned int HardwareManager::getAmbientReading() const {
+    return ambientLight.getReading();
 }
 
-void HardwareManager::startMultiLEDBlink(const byte* pins, byte pinCount, byte count, unsigned int interval) {
-    multiLedBlinkActive = true;
-    multiLedPinCount = pinCount;
-    
-    for (byte i = 0; i < pinCount && i < 3; i++) {
-        multiLedPins[i] = pins[i];
-    }
-    
-    ledBlinkMaxCount = count;
-    ledBlinkCount = 0;
-    ledBlinkInterval = interval;
-    ledBlinkState = false;
-    ledBlinkStartTime = millis();
-    lastLEDToggleTime = millis();
-    
-    ledBlinkActive = false; // Disable single LED if multi-LED starts
+const AmbientLightConfig& HardwareManager::getBacklightConfig() const {
+    return ambientLight.getConfig();
 }
 
-void HardwareManager::updateLEDBlink() {
-    if (!ledBlinkActive && !multiLedBlinkActive) return;
-    
-    unsigned long currentTime = millis();
-    
-    // Check if we've completed all blinks
-    if (ledBlinkCount >= ledBlinkMaxCount * 2) { // *2 because each blink = ON + OFF
-        if (ledBlinkActive) {
-            digitalWrite(ledBlinkPin, LOW);
-            ledBlinkActive = false;
-        }
-        if (multiLedBlinkActive) {
-            for (byte i = 0; i < multiLedPinCount; i++) {
-                digitalWrite(multiLedPins[i], LOW);
-            }
-            multiLedBlinkActive = false;
-        }
-        return;
-    }
-    
-    // Toggle LEDs at interval
-    if (currentTime - lastLEDToggleTime >= ledBlinkInterval) {
-        ledBlinkState = !ledBlinkState;
-        
-        if (ledBlinkActive) {
-            digitalWrite(ledBlinkPin, ledBlinkState ? HIGH : LOW);
-        }
-        
-        if (multiLedBlinkActive) {
-            for (byte i = 0; i < multiLedPinCount; i++) {
-                digitalWrite(multiLedPins[i], ledBlinkState ? HIGH : LOW);
-            }
-        }
-        
-        ledBlinkCount++;
-        lastLEDToggleTime = currentTime;
-    }
+void HardwareManager::setBacklightConfig(const AmbientLightConfig& config) {
+    ambientLight.setConfig(config);
+}
+
+// LED Management Helper Methods
+void HardwareManager::setStatusLevels(byte defeatLevel, byte winLevel, byte bonusLevel) {
+    ledEffects.setLevel(LED_DEFEAT, LAYER_BASE, defeatLevel);
+    ledEffects.setLevel(LED_WIN, LAYER_BASE, winLevel);
+    ledEffects.setLevel(LED_BONUS, LAYER_BASE, bonusLevel);
 }
 
 // Status LED Control
 void HardwareManager::updateStatusLEDs(GameState state) {
-    // Update any active blink animations
-    updateLEDBlink();
-    
-    // Don't override active blink animations
-    if (ledBlinkActive || multiLedBlinkActive) return;
-    
-    unsigned long currentTime = millis();
-    static unsigned long lastStateLEDUpdate = 0;
-    static bool stateLEDState = false;
-    const unsigned int STATE_LED_BLINK_INTERVAL = 500;
+    // Base layer only changes with the game state; event effects play on top of it
+    if (statusLEDsInitialized && state == lastStatusState) return;
+    statusLEDsInitialized = true;
+    lastStatusState = state;
     
     switch (state) {
         case MENU:
-            turnOffAllLEDs();
+            setStatusLevels(0, 0, 0);
             break;
             
         case PLAYING:
-            turnOffAllLEDs();
-            digitalWrite(bonusLightPin, HIGH); // Indicates game is active
+            setStatusLevels(0, 0, 255); // Bonus LED indicates game is active
             break;
             
         case PAUSED:
-            // Blink bonus LED to indicate pause
-            if (currentTime - lastStateLEDUpdate >= STATE_LED_BLINK_INTERVAL) {
-                stateLEDState = !stateLEDState;
-                digitalWrite(bonusLightPin, stateLEDState ? HIGH : LOW);
-                lastStateLEDUpdate = currentTime;
-            }
+            // Breathe bonus LED to indicate pause
+            setStatusLevels(0, 0, 0);
+            ledEffects.play(LED_BONUS, LAYER_BASE, breatheEffect, 2, 0);
             break;
             
         case GAME_OVER:
-            turnOffAllLEDs();
-            digitalWrite(defeatLightPin, HIGH);
+            setStatusLevels(255, 0, 0);
             break;
             
         case VICTORY:
-            turnOffAllLEDs();
-            digitalWrite(winLightPin, HIGH);
+            setStatusLevels(0, 255, 0);
             break;
     }
 }
 
 void HardwareManager::blinkDefeatLED() {
-    startLEDBlink(defeatLightPin, 6, 100); // 6 blinks, 100ms interval
+    ledEffects.play(LED_DEFEAT, LAYER_EVENT, fastBlinkEffect, 2, 6); // 6 blinks, 100ms interval
 }
 
 void HardwareManager::blinkWinLED() {
-    byte pins[] = {winLightPin, bonusLightPin};
-    startMultiLEDBlink(pins, 2, 3, 200); // 3 blinks, 200ms interval
+    ledEffects.play(LED_WIN, LAYER_EVENT, slowBlinkEffect, 2, 3); // 3 blinks, 200ms interval
+    ledEffects.play(LED_BONUS, LAYER_EVENT, slowBlinkEffect, 2, 3);
 }
 
 void HardwareManager::blinkBonusLED() {
-    startLEDBlink(bonusLightPin, 2, 100); // 2 quick blinks, 100ms interval
+    ledEffects.play(LED_BONUS, LAYER_EVENT, fastBlinkEffect, 2, 2); // 2 quick blinks, 100ms interval
 }
 
 // Buzzer Control
@@ -376,5 +311,6 @@ bool HardwareManager::isSoundPlaying() const {
 void HardwareManager::update(GameState currentState) {
     updateBacklight();
     updateStatusLEDs(currentState);
+    ledEffects.update();
     updateBuzzer();
 }
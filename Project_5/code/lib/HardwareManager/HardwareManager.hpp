@@ -4,6 +4,8 @@
 
 #include <Arduino.h>
 #include "GameModel.hpp"
+#include "LEDEffectEngine.hpp"
+#include "AmbientLight.hpp"
 
 // Sound Types
 enum SoundType {
@@ -35,27 +37,15 @@ private:
     const byte buzzerPin;
     
     // Backlight Management
-    unsigned long lastBacklightCheckTime;
-    const unsigned int BACKLIGHT_CHECK_INTERVAL = 500; // Check every 500ms
-    const int BRIGHTNESS_THRESHOLD = 300; // Adjust based on your photosensor
+    AmbientLight ambientLight;
+    byte backlightLevel;
     bool backlightState;
     bool autoBacklightEnabled;
     
-    // LED Blink Management
-    unsigned long ledBlinkStartTime;
-    unsigned int ledBlinkDuration;
-    unsigned int ledBlinkInterval;
-    byte ledBlinkCount;
-    byte ledBlinkMaxCount;
-    byte ledBlinkPin;
-    bool ledBlinkActive;
-    bool ledBlinkState;
-    unsigned long lastLEDToggleTime;
-    
-    // Multi-LED Blink (for victory animation)
-    bool multiLedBlinkActive;
-    byte multiLedPins[3];
-    byte multiLedPinCount;
+    // LED Effects (status LEDs and backlight)
+    LEDEffectEngine ledEffects;
+    GameState lastStatusState;
+    bool statusLEDsInitialized;
     
     // Buzzer Management (Non-blocking Melody)
     bool buzzerEnabled;
@@ -73,11 +63,13 @@ private:
     static const MelodyNote victoryMelody[];
     static const MelodyNote gameOverMelody[];
     
+    // Predefined LED Effects
+    static const Keyframe fastBlinkEffect[];
+    static const Keyframe slowBlinkEffect[];
+    static const Keyframe breatheEffect[];
+    
     // Helper Methods
-    void turnOffAllLEDs();
-    void startLEDBlink(byte pin, byte count, unsigned int interval);
-    void startMultiLEDBlink(const byte* pins, byte pinCount, byte count, unsigned int interval);
-    void updateLEDBlink();
+    void setStatusLevels(byte defeatLevel, byte winLevel, byte bonusLevel);
     void startMelody(const MelodyNote* melody, byte length);
     void updateMelody();
     void playSimpleTone(unsigned int frequency, unsigned int duration);
@@ -94,6 +86,10 @@ public:
     void setAutoBacklight(bool enabled);
     bool getAutoBacklight() const;
     void setBacklight(bool on);
+    byte getBacklightLevel() const;
+    unsigned int getAmbientReading() const;
+    const AmbientLightConfig& getBacklightConfig() const;
+    void setBacklightConfig(const AmbientLightConfig& config);
     
     // Status LED Control
     void updateStatusLEDs(GameState state);
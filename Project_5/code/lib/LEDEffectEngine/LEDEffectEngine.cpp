@@ -0,0 +1,230 @@
+// LEDEffectEngine.cpp
+#include "LEDEffectEngine.hpp"
+
+// Engine serviced by the timer interrupt
+static LEDEffectEngine* pwmEngine = nullptr;
+
+// Lowest nonzero software PWM level, see pwmTick()
+static const byte SOFT_PWM_FLOOR = 27;
+
+// Timer0 keeps running for millis(); its compare A match gives us a free ~1 kHz tick
+ISR(TIMER0_COMPA_vect) {
+    if (pwmEngine != nullptr) {
+        pwmEngine->pwmTick();
+    }
+}
+
+LEDEffectEngine::LEDEffectEngine(byte defeatPin, byte winPin, byte bonusPin, byte backlightPin) {
+    pins[LED_DEFEAT] = defeatPin;
+    pins[LED_WIN] = winPin;
+    pins[LED_BONUS] = bonusPin;
+    pins[LED_BACKLIGHT] = backlightPin;
+
+    for (byte channel = 0; channel < LED_CHANNEL_COUNT; channel++) {
+        hasHardwarePWM[channel] = false;
+        outputRegisters[channel] = nullptr;
+        pinMasks[channel] = 0;
+        outputLevels[channel] = 0;
+        pwmAccumulators[channel] = 0;
+        pwmOutputStates[channel] = false;
+
+        for (byte layer = 0; layer < LED_LAYER_COUNT; layer++) {
+            tracks[channel][layer].frames = nullptr;
+            tracks[channel][layer].frameCount = 0;
+            tracks[channel][layer].active = false;
+        }
+    }
+}
+
+void LEDEffectEngine::initialize() {
+    for (byte channel = 0; channel < LED_CHANNEL_COUNT; channel++) {
+        pinMode(pins[channel], OUTPUT);
+        digitalWrite(pins[channel], LOW);
+
+        // Pins without a timer output get software PWM through the port register
+        hasHardwarePWM[channel] = (digitalPinToTimer(pins[channel]) != NOT_ON_TIMER);
+        outputRegisters[channel] = portOutputRegister(digitalPinToPort(pins[channel]));
+        pinMasks[channel] = digitalPinToBitMask(pins[channel]);
+    }
+
+    noInterrupts();
+    pwmEngine = this;
+    OCR0A = 0x80;           // Any value works, the match happens once per overflow
+    TIMSK0 |= _BV(OCIE0A);
+    interrupts();
+}
+
+// Effect Control
+void LEDEffectEngine::play(LEDChannel channel, LEDLayer layer, const Keyframe* frames,
+                           byte frameCount, byte repeats) {
+    if (channel >= LED_CHANNEL_COUNT || layer >= LED_LAYER_COUNT) return;
+    if (frames == nullptr || frameCount == 0) return;
+
+    LEDTrack& track = tracks[channel][layer];
+    track.frames = frames;
+    track.frameCount = frameCount;
+    track.frameIndex = 0;
+    track.repeatsLeft = repeats;
+    track.fromLevel = outputLevels[channel]; // Fade from whatever is showing now
+    track.frameStartTime = millis();
+    track.active = true;
+}
+
+void LEDEffectEngine::setLevel(LEDChannel channel, LEDLayer layer, byte level) {
+    if (channel >= LED_CHANNEL_COUNT || layer >= LED_LAYER_COUNT) return;
+
+    LEDTrack& track = tracks[channel][layer];
+    track.holdFrame.level = level;
+    track.holdFrame.duration = 0xFFFF;
+    track.holdFrame.easing = EASE_STEP;
+    play(channel, layer, &track.holdFrame, 1, 0);
+}
+
+void LEDEffectEngine::stop(LEDChannel channel, LEDLayer layer) {
+    if (channel >= LED_CHANNEL_COUNT || layer >= LED_LAYER_COUNT) return;
+    tracks[channel][layer].active = false;
+}
+
+void LEDEffectEngine::stopAll(LEDLayer layer) {
+    for (byte channel = 0; channel < LED_CHANNEL_COUNT; channel++) {
+        stop((LEDChannel)channel, layer);
+    }
+}
+
+bool LEDEffectEngine::isPlaying(LEDChannel channel, LEDLayer layer) const {
+    if (channel >= LED_CHANNEL_COUNT || layer >= LED_LAYER_COUNT) return false;
+    return tracks[channel][layer].active;
+}
+
+byte LEDEffectEngine::getLevel(LEDChannel channel) const {
+    if (channel >= LED_CHANNEL_COUNT) return 0;
+    return outputLevels[channel];
+}
+
+// Track Evaluation
+byte LEDEffectEngine::applyEasing(byte from, byte to, byte progress, Easing easing) const {
+    unsigned int curve;
+
+    switch (easing) {
+        case EASE_STEP:
+            return to;
+        case EASE_IN:
+            curve = ((unsigned int)progress * progress) >> 8;
+            break;
+        case EASE_OUT:
+            curve = 255 - ((((unsigned int)(255 - progress)) * (255 - progress)) >> 8);
+            break;
+        case EASE_LINEAR:
+        default:
+            curve = progress;
+            break;
+    }
+
+    int delta = (int)to - (int)from;
+    return (byte)(from + (delta * (int)curve) / 255);
+}
+
+byte LEDEffectEngine::evaluateTrack(LEDTrack& track, unsigned long currentTime) {
+    // Skip over finished keyframes (bounded, so a late update can't stall the loop)
+    for (byte skipped = 0; skipped <= track.frameCount; skipped++) {
+        const Keyframe& frame = track.frames[track.frameIndex];
+        unsigned long elapsed = currentTime - track.frameStartTime;
+
+        if (elapsed < frame.duration) {
+            byte progress = (byte)((elapsed * 255UL) / frame.duration);
+            return applyEasing(track.fromLevel, frame.level, progress, frame.easing);
+        }
+
+        // Keyframe finished, move on to the next one
+        track.fromLevel = frame.level;
+        track.frameStartTime += frame.duration;
+        track.frameIndex++;
+
+        if (track.frameIndex >= track.frameCount) {
+            track.frameIndex = 0;
+
+            if (track.repeatsLeft > 0) {
+                track.repeatsLeft--;
+                if (track.repeatsLeft == 0) {
+                    track.active = false;
+                    return track.fromLevel;
+                }
+            }
+        }
+    }
+
+    // Far behind schedule: resynchronize on the current keyframe
+    track.frameStartTime = currentTime;
+    return track.fromLevel;
+}
+
+void LEDEffectEngine::applyLevel(byte channel, byte level) {
+    if (!hasHardwarePWM[channel]) {
+        if (level < SOFT_PWM_FLOOR) level = 0;
+        else if (level > 255 - SOFT_PWM_FLOOR) level = 255;
+    }
+    if (outputLevels[channel] == level) return; // Nothing changed, no pin access
+
+    outputLevels[channel] = level;
+
+    if (hasHardwarePWM[channel]) {
+        analogWrite(pins[channel], level);
+    }
+    // Software channels pick the new level up on the next pwmTick()
+}
+
+// Update Method (call this in main loop)
+void LEDEffectEngine::update() {
+    unsigned long currentTime = millis();
+
+    for (byte channel = 0; channel < LED_CHANNEL_COUNT; channel++) {
+        byte level = 0;
+
+        // Every active track keeps advancing; the highest active layer wins
+        for (byte layer = 0; layer < LED_LAYER_COUNT; layer++) {
+            LEDTrack& track = tracks[channel][layer];
+            if (!track.active) continue;
+
+            byte trackLevel = evaluateTrack(track, currentTime);
+            if (track.active) {
+                level = trackLevel;
+            }
+        }
+
+        applyLevel(channel, level);
+    }
+}
+
+// Software PWM (first-order sigma-delta, 8-bit resolution at the ~1 kHz tick)
+// A level L pulses at 976 Hz * L / 256, so the dimmest levels blink visibly
+// (L = 8 is ~30 Hz). applyLevel() snaps software channels below
+// SOFT_PWM_FLOOR to off and above 255 - SOFT_PWM_FLOOR to fully on, which
+// keeps every pulse train at ~100 Hz or faster.
+void LEDEffectEngine::pwmTick() {
+    for (byte channel = 0; channel < LED_CHANNEL_COUNT; channel++) {
+        if (hasHardwarePWM[channel] || outputRegisters[channel] == nullptr) continue;
+
+        byte level = outputLevels[channel];
+        bool on;
+
+        if (level == 0) {
+            on = false;
+        } else if (level == 255) {
+            on = true;
+        } else {
+            unsigned int sum = pwmAccumulators[channel] + level;
+            pwmAccumulators[channel] = (byte)sum;
+            on = (sum > 0xFF);
+        }
+
+        // Only touch the port when the output actually changes
+        if (on != pwmOutputStates[channel]) {
+            pwmOutputStates[channel] = on;
+            if (on) {
+                *outputRegisters[channel] |= pinMasks[channel];
+            } else {
+                *outputRegisters[channel] &= ~pinMasks[channel];
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+// LEDEffectEngine.hpp
+#ifndef LED_EFFECT_ENGINE_HPP
+#define LED_EFFECT_ENGINE_HPP
+
+#include <Arduino.h>
+
+// Output Channels (one independent set of tracks per LED)
+enum LEDChannel {
+    LED_DEFEAT,
+    LED_WIN,
+    LED_BONUS,
+    LED_BACKLIGHT,
+    LED_CHANNEL_COUNT
+};
+
+// Priority Layers (higher value wins when several tracks are active)
+enum LEDLayer {
+    LAYER_BASE,   // Steady state indication (menu, playing, paused...)
+    LAYER_EVENT,  // Short one-shot effects (cup collected, death...)
+    LED_LAYER_COUNT
+};
+
+// Interpolation used to reach a keyframe's level
+enum Easing {
+    EASE_STEP,    // Jump to the level immediately, then hold
+    EASE_LINEAR,
+    EASE_IN,      // Quadratic, slow start
+    EASE_OUT      // Quadratic, slow finish
+};
+
+// Keyframe: reach 'level' (0-255) over 'duration' ms using 'easing'
+struct Keyframe {
+    byte level;
+    unsigned int duration;
+    Easing easing;
+};
+
+// Playback state of one keyframe sequence
+struct LEDTrack {
+    const Keyframe* frames;
+    byte frameCount;
+    byte frameIndex;
+    byte repeatsLeft;     // 0 = loop forever
+    byte fromLevel;       // Level at the start of the current keyframe
+    unsigned long frameStartTime;
+    Keyframe holdFrame;   // Storage for constant levels set via setLevel()
+    bool active;
+};
+
+class LEDEffectEngine {
+private:
+    // Pin References
+    byte pins[LED_CHANNEL_COUNT];
+    bool hasHardwarePWM[LED_CHANNEL_COUNT];
+
+    // Direct port access for the software PWM channels
+    volatile uint8_t* outputRegisters[LED_CHANNEL_COUNT];
+    uint8_t pinMasks[LED_CHANNEL_COUNT];
+
+    // Tracks (channel x layer)
+    LEDTrack tracks[LED_CHANNEL_COUNT][LED_LAYER_COUNT];
+
+    // Composed output levels (read by the PWM interrupt)
+    volatile byte outputLevels[LED_CHANNEL_COUNT];
+    byte pwmAccumulators[LED_CHANNEL_COUNT];
+    bool pwmOutputStates[LED_CHANNEL_COUNT];
+
+    // Helper Methods
+    byte evaluateTrack(LEDTrack& track, unsigned long currentTime);
+    byte applyEasing(byte from, byte to, byte progress, Easing easing) const;
+    void applyLevel(byte channel, byte level);
+
+public:
+    LEDEffectEngine(byte defeatPin, byte winPin, byte bonusPin, byte backlightPin);
+
+    // Initialization (configures pins and the PWM timer interrupt)
+    void initialize();
+
+    // Effect Control
+    void play(LEDChannel channel, LEDLayer layer, const Keyframe* frames,
+              byte frameCount, byte repeats = 1);
+    void setLevel(LEDChannel channel, LEDLayer layer, byte level);
+    void stop(LEDChannel channel, LEDLayer layer);
+    void stopAll(LEDLayer layer);
+    bool isPlaying(LEDChannel channel, LEDLayer layer) const;
+    byte getLevel(LEDChannel channel) const;
+
+    // Advance all tracks (call this in main loop)
+    void update();
+
+    // Software PWM step (called from the timer interrupt)
+    void pwmTick();
+};
+
+#endif // LED_EFFECT_ENGINE_HPP
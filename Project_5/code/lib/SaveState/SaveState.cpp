@@ -0,0 +1,106 @@
+// SaveState.cpp
+#include "SaveState.hpp"
+#include <EEPROM.h>
+#include <stddef.h>
+
+SaveState::SaveState(int eepromAddress) : baseAddress(eepromAddress) {
+    activeSlot = -1;
+    sequence = 0;
+    lastWriteMicros = 0;
+}
+
+int SaveState::slotAddress(byte slot) const {
+    return baseAddress + slot * sizeof(SaveSlot);
+}
+
+// CRC-16/CCITT (poly 0x1021, init 0xFFFF)
+unsigned int SaveState::calculateCRC(const SaveSlot& slot) const {
+    const byte* bytes = (const byte*)&slot;
+    unsigned int crc = 0xFFFF;
+
+    for (byte i = 0; i < offsetof(SaveSlot, crc); i++) {
+        crc ^= (unsigned int)bytes[i] << 8;
+        for (byte bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc & 0xFFFF;
+}
+
+bool SaveState::readSlot(byte slot, SaveSlot& data) const {
+    EEPROM.get(slotAddress(slot), data);
+
+    if (data.magic != SLOT_MAGIC) return false;
+    return data.crc == calculateCRC(data);
+}
+
+void SaveState::initialize() {
+    activeSlot = -1;
+    sequence = 0;
+
+    for (byte i = 0; i < SLOT_COUNT; i++) {
+        SaveSlot data;
+        if (!readSlot(i, data)) continue;
+
+        // Wrap-safe "newer than"
+        if (activeSlot < 0 || (int)(data.sequence - sequence) > 0) {
+            activeSlot = i;
+            sequence = data.sequence;
+        }
+    }
+}
+
+bool SaveState::hasSnapshot() const {
+    return activeSlot >= 0;
+}
+
+bool SaveState::load(GameSnapshot& snapshot) const {
+    if (activeSlot < 0) return false;
+
+    SaveSlot data;
+    if (!readSlot(activeSlot, data)) return false;
+
+    snapshot = data.snapshot;
+    return true;
+}
+
+void SaveState::save(const GameSnapshot& snapshot) {
+    unsigned long startTime = micros();
+
+    byte targetSlot = (activeSlot == 0) ? 1 : 0;
+
+    SaveSlot data;
+    data.magic = SLOT_MAGIC;
+    data.sequence = sequence + 1;
+    data.snapshot = snapshot;
+    data.crc = calculateCRC(data);
+
+    // put() only rewrites bytes that changed
+    EEPROM.put(slotAddress(targetSlot), data);
+
+    activeSlot = targetSlot;
+    sequence = data.sequence;
+    lastWriteMicros = micros() - startTime;
+}
+
+void SaveState::invalidate() {
+    if (activeSlot < 0) return;
+
+    for (byte i = 0; i < SLOT_COUNT; i++) {
+        EEPROM.update(slotAddress(i), 0x00);
+    }
+    activeSlot = -1;
+}
+
+// Reporting
+unsigned long SaveState::getLastWriteMicros() const {
+    return lastWriteMicros;
+}
+
+byte SaveState::getSnapshotSize() {
+    return sizeof(GameSnapshot);
+}
+
+byte SaveState::getRegionSize() {
+    return SLOT_COUNT * sizeof(SaveSlot);
+}
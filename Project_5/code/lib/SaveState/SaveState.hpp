@@ -0,0 +1,51 @@
+// SaveState.hpp
+#ifndef SAVE_STATE_HPP
+#define SAVE_STATE_HPP
+
+#include <Arduino.h>
+#include "GameModel.hpp"
+
+// One EEPROM slot: the snapshot plus what's needed to trust it
+struct SaveSlot {
+    byte magic;
+    unsigned int sequence; // Newer slot wins
+    GameSnapshot snapshot;
+    unsigned int crc;      // CRC-16 over everything above
+};
+
+// Two-slot (ping-pong) save-state store. Each save goes to the slot not
+// holding the latest valid snapshot, so a write torn by a power cut only
+// ever damages the older copy.
+class SaveState {
+private:
+    static const byte SLOT_MAGIC = 0x5A;
+    static const byte SLOT_COUNT = 2;
+
+    const int baseAddress;
+
+    int activeSlot; // -1 = nothing valid stored
+    unsigned int sequence;
+    unsigned long lastWriteMicros;
+
+    int slotAddress(byte slot) const;
+    unsigned int calculateCRC(const SaveSlot& slot) const;
+    bool readSlot(byte slot, SaveSlot& data) const;
+
+public:
+    SaveState(int eepromAddress);
+
+    // Scan both slots, remember which one is current
+    void initialize();
+
+    bool hasSnapshot() const;
+    bool load(GameSnapshot& snapshot) const;
+    void save(const GameSnapshot& snapshot);
+    void invalidate();
+
+    // Reporting
+    unsigned long getLastWriteMicros() const;
+    static byte getSnapshotSize();
+    static byte getRegionSize();
+};
+
+#endif // SAVE_STATE_HPP
@@ -0,0 +1,228 @@
+// SerialShell.cpp
+#include "SerialShell.hpp"
+#include <EEPROM.h>
+
+// ParamRegistry
+ParamRegistry::ParamRegistry() {
+    paramCount = 0;
+    changeCallback = nullptr;
+}
+
+bool ParamRegistry::add(const __FlashStringHelper* name, void* value, ParamType type,
+                        unsigned int minValue, unsigned int maxValue) {
+    if (paramCount >= MAX_PARAMS) return false;
+
+    TunableParam& param = params[paramCount++];
+    param.name = name;
+    param.value = value;
+    param.type = type;
+    param.minValue = minValue;
+    param.maxValue = maxValue;
+    return true;
+}
+
+bool ParamRegistry::add(const __FlashStringHelper* name, byte* value, byte minValue, byte maxValue) {
+    return add(name, value, PARAM_BYTE, minValue, maxValue);
+}
+
+bool ParamRegistry::add(const __FlashStringHelper* name, unsigned int* value,
+                        unsigned int minValue, unsigned int maxValue) {
+    return add(name, value, PARAM_UINT, minValue, maxValue);
+}
+
+void ParamRegistry::setChangeCallback(void (*callback)()) {
+    changeCallback = callback;
+}
+
+byte ParamRegistry::getCount() const {
+    return paramCount;
+}
+
+int ParamRegistry::find(const char* name) const {
+    for (byte i = 0; i < paramCount; i++) {
+        if (strcmp_P(name, (const char*)params[i].name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const __FlashStringHelper* ParamRegistry::getName(byte index) const {
+    return (index < paramCount) ? params[index].name : nullptr;
+}
+
+unsigned int ParamRegistry::get(byte index) const {
+    if (index >= paramCount) return 0;
+
+    if (params[index].type == PARAM_BYTE) {
+        return *(byte*)params[index].value;
+    }
+    return *(unsigned int*)params[index].value;
+}
+
+void ParamRegistry::write(byte index, unsigned int value) {
+    if (params[index].type == PARAM_BYTE) {
+        *(byte*)params[index].value = (byte)value;
+    } else {
+        *(unsigned int*)params[index].value = value;
+    }
+}
+
+bool ParamRegistry::set(byte index, unsigned int value) {
+    if (index >= paramCount) return false;
+    if (value < params[index].minValue || value > params[index].maxValue) return false;
+
+    write(index, value);
+    if (changeCallback != nullptr) {
+        changeCallback();
+    }
+    return true;
+}
+
+void ParamRegistry::print(byte index) const {
+    if (index >= paramCount) return;
+
+    Serial.print(params[index].name);
+    Serial.print(F(" = "));
+    Serial.print(get(index));
+    Serial.print(F("  ["));
+    Serial.print(params[index].minValue);
+    Serial.print(F("-"));
+    Serial.print(params[index].maxValue);
+    Serial.println(F("]"));
+}
+
+byte ParamRegistry::calculateChecksum(const unsigned int* values, byte count) const {
+    byte checksum = EEPROM_MAGIC ^ count;
+    for (byte i = 0; i < count; i++) {
+        checksum ^= (values[i] & 0xFF);
+        checksum ^= ((values[i] >> 8) & 0xFF);
+    }
+    return checksum;
+}
+
+// EEPROM layout: magic, count, count x value (2 bytes), checksum
+bool ParamRegistry::loadFromEEPROM(int eepromAddress) {
+    if (EEPROM.read(eepromAddress) != EEPROM_MAGIC) return false;
+    if (EEPROM.read(eepromAddress + 1) != paramCount) return false;
+
+    unsigned int values[MAX_PARAMS];
+    int address = eepromAddress + 2;
+    for (byte i = 0; i < paramCount; i++) {
+        EEPROM.get(address, values[i]);
+        address += sizeof(unsigned int);
+    }
+
+    if (EEPROM.read(address) != calculateChecksum(values, paramCount)) return false;
+
+    // Only accept values that are still in range for this firmware
+    for (byte i = 0; i < paramCount; i++) {
+        if (values[i] >= params[i].minValue && values[i] <= params[i].maxValue) {
+            write(i, values[i]);
+        }
+    }
+
+    if (changeCallback != nullptr) {
+        changeCallback();
+    }
+    return true;
+}
+
+void ParamRegistry::saveToEEPROM(int eepromAddress) const {
+    unsigned int values[MAX_PARAMS];
+
+    EEPROM.update(eepromAddress, EEPROM_MAGIC);
+    EEPROM.update(eepromAddress + 1, paramCount);
+
+    int address = eepromAddress + 2;
+    for (byte i = 0; i < paramCount; i++) {
+        values[i] = get(i);
+        EEPROM.put(address, values[i]);
+        address += sizeof(unsigned int);
+    }
+
+    EEPROM.update(address, calculateChecksum(values, paramCount));
+}
+
+// SerialShell
+SerialShell::SerialShell(const ShellCommand* commandTable, byte count)
+    : commands(commandTable), commandCount(count) {
+    lineLength = 0;
+    lineOverflow = false;
+    lineBuffer[0] = '\0';
+}
+
+char* SerialShell::nextToken(char*& cursor) {
+    while (*cursor == ' ') cursor++;
+
+    char* token = cursor;
+    while (*cursor != '\0' && *cursor != ' ') cursor++;
+
+    if (*cursor == ' ') {
+        *cursor = '\0';
+        cursor++;
+    }
+    return token;
+}
+
+void SerialShell::update() {
+    while (Serial.available() > 0) {
+        char incoming = Serial.read();
+
+        if (incoming == '\n' || incoming == '\r') {
+            if (lineOverflow) {
+                Serial.println(F("Line too long"));
+            } else if (lineLength > 0) {
+                lineBuffer[lineLength] = '\0';
+                execute(lineBuffer);
+            }
+            lineLength = 0;
+            lineOverflow = false;
+            continue;
+        }
+
+        if (incoming == '\b' || incoming == 0x7F) {
+            if (lineLength > 0) lineLength--;
+            continue;
+        }
+
+        if (lineLength < LINE_LENGTH) {
+            lineBuffer[lineLength++] = incoming;
+        } else {
+            lineOverflow = true;
+        }
+    }
+}
+
+void SerialShell::execute(char* line) {
+    char* cursor = line;
+    char* name = nextToken(cursor);
+    if (*name == '\0') return;
+
+    for (byte i = 0; i < commandCount; i++) {
+        ShellCommand command;
+        memcpy_P(&command, &commands[i], sizeof(ShellCommand));
+
+        if (strcmp_P(name, command.name) == 0) {
+            while (*cursor == ' ') cursor++;
+            command.handler(cursor);
+            return;
+        }
+    }
+
+    Serial.print(F("Unknown command: "));
+    Serial.println(name);
+}
+
+void SerialShell::printHelp() const {
+    Serial.println(F("\n=== COMMANDS ==="));
+    for (byte i = 0; i < commandCount; i++) {
+        ShellCommand command;
+        memcpy_P(&command, &commands[i], sizeof(ShellCommand));
+
+        Serial.print((const __FlashStringHelper*)command.name);
+        Serial.print(F(" - "));
+        Serial.println((const __FlashStringHelper*)command.help);
+    }
+    Serial.println(F("================\n"));
+}
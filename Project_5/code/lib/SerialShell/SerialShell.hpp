@@ -0,0 +1,94 @@
+// SerialShell.hpp
+#ifndef SERIAL_SHELL_HPP
+#define SERIAL_SHELL_HPP
+
+#include <Arduino.h>
+
+// Command Handler (receives the text after the command name, never null)
+typedef void (*ShellHandler)(char* args);
+
+// Command Table Entry (the table and its strings live in PROGMEM)
+struct ShellCommand {
+    const char* name;
+    const char* help;
+    ShellHandler handler;
+};
+
+// Tunable Parameter Types
+enum ParamType {
+    PARAM_BYTE,
+    PARAM_UINT
+};
+
+struct TunableParam {
+    const __FlashStringHelper* name;
+    void* value;
+    ParamType type;
+    unsigned int minValue;
+    unsigned int maxValue;
+};
+
+// Registry of runtime-tunable parameters with optional EEPROM persistence
+class ParamRegistry {
+private:
+    static const byte MAX_PARAMS = 16;
+    static const byte EEPROM_MAGIC = 0xA7;
+
+    TunableParam params[MAX_PARAMS];
+    byte paramCount;
+    void (*changeCallback)();
+
+    bool add(const __FlashStringHelper* name, void* value, ParamType type,
+             unsigned int minValue, unsigned int maxValue);
+    void write(byte index, unsigned int value);
+    byte calculateChecksum(const unsigned int* values, byte count) const;
+
+public:
+    ParamRegistry();
+
+    // Registration
+    bool add(const __FlashStringHelper* name, byte* value, byte minValue, byte maxValue);
+    bool add(const __FlashStringHelper* name, unsigned int* value,
+             unsigned int minValue, unsigned int maxValue);
+    void setChangeCallback(void (*callback)());
+
+    // Access
+    byte getCount() const;
+    int find(const char* name) const;
+    const __FlashStringHelper* getName(byte index) const;
+    unsigned int get(byte index) const;
+    bool set(byte index, unsigned int value); // false if out of range
+    void print(byte index) const;
+
+    // Persistence
+    bool loadFromEEPROM(int eepromAddress);
+    void saveToEEPROM(int eepromAddress) const;
+};
+
+// Line-based command shell (non-blocking)
+class SerialShell {
+private:
+    const ShellCommand* commands; // PROGMEM
+    byte commandCount;
+
+    static const byte LINE_LENGTH = 40;
+    char lineBuffer[LINE_LENGTH + 1];
+    byte lineLength;
+    bool lineOverflow;
+
+    void execute(char* line);
+
+public:
+    SerialShell(const ShellCommand* commandTable, byte count);
+
+    // Drain available characters, run a command on every complete line
+    void update();
+
+    // Print every command with its help text
+    void printHelp() const;
+
+    // Tokenizer helper: splits off the next word, returns it (empty if none)
+    static char* nextToken(char*& cursor);
+};
+
+#endif // SERIAL_SHELL_HPP
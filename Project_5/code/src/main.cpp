@@ -1,6 +1,8 @@
 #include <Arduino.h>
 #include <LiquidCrystal.h>
 #include <EEPROM.h>
+#include <limits.h>
+#include <avr/sleep.h>
 
 #include "GameModel.hpp"
 #include "HardwareManager.hpp"
@@ -8,6 +10,9 @@
 #include "IRenderer.hpp"
 #include "LCDRenderer.hpp"
 #include "SerialRenderer.hpp"
+#include "CompositeRenderer.hpp"
+#include "SerialShell.hpp"
+#include "ButtonEvents.hpp"
 
 // LCD Pins
 const byte RS_LCD_PIN = 8;
@@ -33,17 +38,20 @@ const byte WIN_LIGHT_PIN = A4;
 const byte BONUS_LIGHT_PIN = A5;
 const byte BUZZER_PIN = 11;
 
-// Choose renderer: true = LCD, false = Serial (for debugging)
+// Renderers: the LCD and an optional serial mirror (for debugging), each at its own rate
 const bool USE_LCD_RENDERER = true;
+const bool USE_SERIAL_MIRROR = false;
+const unsigned int LCD_FRAME_INTERVAL = 50;     // 20 Hz
+const unsigned int SERIAL_FRAME_INTERVAL = 500; // 2 Hz
 
 // EEPROM address for highscores
 const int EEPROM_ADDRESS = 0;
 
-// Debouncing
-const unsigned int DEBOUNCING_TIME = 200; // milliseconds
+// EEPROM address for the tunable parameters (save-state slots follow at 128)
+const int PARAMS_EEPROM_ADDRESS = 32;
 
-// Rendering timing
-const unsigned int RENDER_INTERVAL = 200; // Render every 200ms
+// Frame capture timing (tunable through the serial shell), children throttle further
+unsigned int renderInterval = 50; // Capture a frame every 50ms
 
 // Hardware
 LiquidCrystal lcd(RS_LCD_PIN, EN_LCD_PIN, D4_LCD_PIN, D5_LCD_PIN, D6_LCD_PIN, D7_LCD_PIN);
@@ -55,32 +63,48 @@ HardwareManager hardwareManager(PHOTOSENSOR_PIN, BACKLIGHT_PIN, DEFEAT_LIGHT_PIN
 GameController gameController(gameModel, hardwareManager, 
                               JOYSTICK_X_AXIS_PIN, JOYSTICK_Y_AXIS_PIN);
 
-// Renderers (only one will be used based on USE_LCD_RENDERER)
+// Renderers (the composite fans each frame out to the enabled ones)
 LCDRenderer lcdRenderer(lcd);
 SerialRenderer serialRenderer;
-IRenderer* activeRenderer = nullptr; // Pointer to active renderer
+CompositeRenderer compositeRenderer;
+IRenderer* activeRenderer = &compositeRenderer;
 
 // Timing
 unsigned long lastRenderTime = 0;
 unsigned long lastDebugTime = 0;
 
-volatile bool selectButtonPressed = false;
-volatile bool pauseButtonPressed = false;
-volatile unsigned long lastButtonPressTime = 0;
+// Idle Sleep (time spent asleep vs. total, for duty-cycle instrumentation)
+byte idleSleepEnabled = 1;
+unsigned long dutyWindowStart = 0;
+unsigned long idleMicros = 0;
+
+// Buttons (the ISRs only record edges, debouncing happens in loop())
+enum ButtonId {
+    SELECT_BUTTON,
+    PAUSE_BUTTON,
+    BUTTON_COUNT
+};
+
+ButtonEvents buttonEvents(BUTTON_COUNT);
 
 void selectButtonISR() {
-    unsigned long currentTime = millis();
-    if (currentTime - lastButtonPressTime > DEBOUNCING_TIME) {
-        selectButtonPressed = true;
-        lastButtonPressTime = currentTime;
-    }
+    buttonEvents.push(SELECT_BUTTON, digitalRead(JOYSTICK_BUTTON_PIN) == LOW);
 }
 
 void pauseButtonISR() {
-    unsigned long currentTime = millis();
-    if (currentTime - lastButtonPressTime > DEBOUNCING_TIME) {
-        pauseButtonPressed = true;
-        lastButtonPressTime = currentTime;
+    buttonEvents.push(PAUSE_BUTTON, digitalRead(PAUSE_BUTTON_PIN) == LOW);
+}
+
+void handleButtonEvent(const ButtonEvent& event) {
+    if (event.type != BUTTON_PRESS) return;
+    
+    switch (event.button) {
+        case SELECT_BUTTON:
+            gameController.handleSelectButton();
+            break;
+        case PAUSE_BUTTON:
+            gameController.handlePauseButton();
+            break;
     }
 }
 
@@ -132,7 +156,7 @@ void renderCurrentState() {
     unsigned long currentTime = millis();
     
     // Throttle rendering to prevent excessive updates
-    if (currentTime - lastRenderTime < RENDER_INTERVAL) {
+    if (currentTime - lastRenderTime < renderInterval) {
         return;
     }
     lastRenderTime = currentTime;
@@ -183,6 +207,43 @@ void renderCurrentState() {
     activeRenderer->update();
 }
 
+bool hasPendingWork() {
+    return buttonEvents.hasPending() || Serial.available() > 0;
+}
+
+void idleUntil(unsigned long dueTime) {
+    unsigned long sleepStart = micros();
+    
+    while ((long)(dueTime - millis()) > 0) {
+        // Check and sleep with interrupts off so a wake-up can't slip in between
+        noInterrupts();
+        if (hasPendingWork()) {
+            interrupts();
+            break;
+        }
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        sleep_enable();
+        interrupts();
+        sleep_cpu(); // Timer ticks, button interrupts and UART RX wake us up
+        sleep_disable();
+    }
+    
+    idleMicros += micros() - sleepStart;
+}
+
+byte getBusyPercent() {
+    unsigned long window = micros() - dutyWindowStart;
+    if (window < 100) return 100;
+    
+    unsigned long idlePercent = idleMicros / (window / 100);
+    return (idlePercent >= 100) ? 0 : 100 - idlePercent;
+}
+
+void resetDutyWindow() {
+    dutyWindowStart = micros();
+    idleMicros = 0;
+}
+
 void printDebugInfo() {
     unsigned long currentTime = millis();
     const unsigned long DEBUG_INTERVAL = 2000; // Print every 2 seconds
@@ -216,6 +277,11 @@ void printDebugInfo() {
     Serial.print(F(") Alive: "));
     Serial.println(player.isAlive ? F("Yes") : F("No"));
     
+    Serial.print(F("CPU busy: "));
+    Serial.print(getBusyPercent());
+    Serial.print(F("%  Button events dropped: "));
+    Serial.println(buttonEvents.getDroppedCount());
+    
     const Room& room = gameModel.getCurrentRoom();
     Serial.print(F("Cups: "));
     Serial.print(room.cupsCollected);
@@ -225,56 +291,183 @@ void printDebugInfo() {
     Serial.println(F("==================\n"));
 }
 
-void handleSerialCommands() {
-    if (!Serial.available()) {
+// Tunable Parameters
+ParamRegistry params;
+AmbientLightConfig backlightTuning;
+
+void applyParams() {
+    hardwareManager.setBacklightConfig(backlightTuning);
+    backlightTuning = hardwareManager.getBacklightConfig(); // Read back sanitized values
+}
+
+void registerParams() {
+    InputConfig& input = gameController.getInputConfig();
+    backlightTuning = hardwareManager.getBacklightConfig();
+    
+    params.add(F("tick_ms"), &gameController.getUpdateInterval(), 10, 500);
+    params.add(F("render_ms"), &renderInterval, 20, 2000);
+    params.add(F("input_ms"), &input.debouncingDelay, 0, 2000);
+    params.add(F("joy_low"), &input.joystickDeadzoneMin, 0, 1023);
+    params.add(F("joy_high"), &input.joystickThreshold, 0, 1023);
+    params.add(F("respawn_ms"), &input.respawnDelay, 0, 10000);
+    params.add(F("bl_dark"), &backlightTuning.darkLevel, 0, 1022);
+    params.add(F("bl_bright"), &backlightTuning.brightLevel, 1, 1023);
+    params.add(F("bl_hyst"), &backlightTuning.hysteresis, 0, 200);
+    params.add(F("bl_min"), &backlightTuning.minBrightness, 0, 255);
+    params.add(F("bl_max"), &backlightTuning.maxBrightness, 0, 255);
+    params.add(F("bl_gamma"), &backlightTuning.gammaTenths, 10, 30);
+    params.add(F("bl_slew"), &backlightTuning.slewRate, 1, 255);
+    params.add(F("bl_smooth"), &backlightTuning.smoothingShift, 0, 6);
+    params.add(F("sleep"), &idleSleepEnabled, 0, 1);
+    params.add(F("btn_debounce"), &buttonEvents.getDebounceTime(), 0, 500);
+    
+    params.setChangeCallback(applyParams);
+}
+
+// Shell Commands
+void cmdHelp(char* args);
+
+void cmdGet(char* args) {
+    if (*args == '\0') {
+        for (byte i = 0; i < params.getCount(); i++) {
+            params.print(i);
+        }
         return;
     }
     
-    char cmd = Serial.read();
+    int index = params.find(SerialShell::nextToken(args));
+    if (index < 0) {
+        Serial.println(F("Unknown parameter"));
+        return;
+    }
+    params.print(index);
+}
+
+void cmdSet(char* args) {
+    char* name = SerialShell::nextToken(args);
+    char* value = SerialShell::nextToken(args);
     
-    switch (cmd) {
-        case 'r': // Reset highscores
-            gameModel.resetHighscores();
-            gameModel.saveHighscoresToEEPROM(EEPROM_ADDRESS);
-            Serial.println(F("Highscores reset!"));
-            break;
-            
-        case 'b': // Toggle buzzer
-            hardwareManager.setBuzzerEnabled(!hardwareManager.getBuzzerEnabled());
-            Serial.print(F("Buzzer: "));
-            Serial.println(hardwareManager.getBuzzerEnabled() ? F("ON") : F("OFF"));
-            break;
-            
-        case 'a': // Toggle auto backlight
-            hardwareManager.setAutoBacklight(!hardwareManager.getAutoBacklight());
-            Serial.print(F("Auto backlight: "));
-            Serial.println(hardwareManager.getAutoBacklight() ? F("ON") : F("OFF"));
-            break;
-            
-        case 'l': // Manual backlight toggle
-            hardwareManager.setAutoBacklight(false);
-            hardwareManager.setBacklight(!hardwareManager.getAutoBacklight());
-            Serial.println(F("Backlight toggled"));
-            break;
-            
-        case 'd': // Toggle debug output
-            Serial.println(F("Debug info will appear every 2 seconds"));
-            break;
-            
-        case 'h': // Help
-            Serial.println(F("\n=== COMMANDS ==="));
-            Serial.println(F("r - Reset highscores"));
-            Serial.println(F("b - Toggle buzzer"));
-            Serial.println(F("a - Toggle auto backlight"));
-            Serial.println(F("l - Manual backlight toggle"));
-            Serial.println(F("d - Show debug info"));
-            Serial.println(F("h - Show this help"));
-            Serial.println(F("================\n"));
-            break;
-            
-        default:
-            break;
+    int index = params.find(name);
+    if (index < 0) {
+        Serial.println(F("Unknown parameter"));
+        return;
+    }
+    // Digits only, and checked against the range before it is narrowed
+    char* end;
+    unsigned long number = isDigit(*value) ? strtoul(value, &end, 10) : 0;
+    if (!isDigit(*value) || *end != '\0') {
+        Serial.println(F("Not a number"));
+        return;
     }
+    if (number > UINT_MAX || !params.set(index, (unsigned int)number)) {
+        Serial.println(F("Value out of range"));
+        return;
+    }
+    params.print(index);
+}
+
+void cmdSave(char*) {
+    params.saveToEEPROM(PARAMS_EEPROM_ADDRESS);
+    Serial.println(F("Parameters saved to EEPROM"));
+}
+
+void cmdLoad(char*) {
+    if (params.loadFromEEPROM(PARAMS_EEPROM_ADDRESS)) {
+        Serial.println(F("Parameters loaded from EEPROM"));
+    } else {
+        Serial.println(F("No saved parameters"));
+    }
+}
+
+void cmdResetScores(char*) {
+    gameModel.resetHighscores();
+    gameModel.saveHighscoresToEEPROM(EEPROM_ADDRESS);
+    Serial.println(F("Highscores reset!"));
+}
+
+void cmdBuzzer(char*) {
+    hardwareManager.setBuzzerEnabled(!hardwareManager.getBuzzerEnabled());
+    Serial.print(F("Buzzer: "));
+    Serial.println(hardwareManager.getBuzzerEnabled() ? F("ON") : F("OFF"));
+}
+
+void cmdAutoLight(char*) {
+    hardwareManager.setAutoBacklight(!hardwareManager.getAutoBacklight());
+    Serial.print(F("Auto backlight: "));
+    Serial.println(hardwareManager.getAutoBacklight() ? F("ON") : F("OFF"));
+}
+
+void cmdLight(char*) {
+    hardwareManager.setAutoBacklight(false);
+    hardwareManager.setBacklight(hardwareManager.getBacklightLevel() == 0);
+    Serial.println(F("Backlight toggled"));
+}
+
+void cmdAmbient(char*) {
+    Serial.print(F("Ambient: "));
+    Serial.print(hardwareManager.getAmbientReading());
+    Serial.print(F("  Backlight: "));
+    Serial.println(hardwareManager.getBacklightLevel());
+}
+
+void cmdDebug(char*) {
+    lastDebugTime = 0;
+    printDebugInfo();
+}
+
+void cmdDuty(char*) {
+    Serial.print(F("CPU busy: "));
+    Serial.print(getBusyPercent());
+    Serial.print(F("% over "));
+    Serial.print((micros() - dutyWindowStart) / 1000);
+    Serial.println(F(" ms"));
+    resetDutyWindow();
+}
+
+const char cmdHelpName[] PROGMEM = "help";
+const char cmdHelpText[] PROGMEM = "Show this help";
+const char cmdGetName[] PROGMEM = "get";
+const char cmdGetText[] PROGMEM = "get [name] - Show parameters";
+const char cmdSetName[] PROGMEM = "set";
+const char cmdSetText[] PROGMEM = "set <name> <value> - Change a parameter";
+const char cmdSaveName[] PROGMEM = "save";
+const char cmdSaveText[] PROGMEM = "Store parameters in EEPROM";
+const char cmdLoadName[] PROGMEM = "load";
+const char cmdLoadText[] PROGMEM = "Reload parameters from EEPROM";
+const char cmdResetName[] PROGMEM = "resetscores";
+const char cmdResetText[] PROGMEM = "Reset highscores";
+const char cmdBuzzerName[] PROGMEM = "buzzer";
+const char cmdBuzzerText[] PROGMEM = "Toggle buzzer";
+const char cmdAutoName[] PROGMEM = "autolight";
+const char cmdAutoText[] PROGMEM = "Toggle auto backlight";
+const char cmdLightName[] PROGMEM = "light";
+const char cmdLightText[] PROGMEM = "Manual backlight toggle";
+const char cmdAmbientName[] PROGMEM = "ambient";
+const char cmdAmbientText[] PROGMEM = "Show photosensor and backlight level";
+const char cmdDebugName[] PROGMEM = "debug";
+const char cmdDebugText[] PROGMEM = "Show debug info";
+const char cmdDutyName[] PROGMEM = "duty";
+const char cmdDutyText[] PROGMEM = "Show CPU busy time and restart the window";
+
+const ShellCommand shellCommands[] PROGMEM = {
+    {cmdHelpName, cmdHelpText, cmdHelp},
+    {cmdGetName, cmdGetText, cmdGet},
+    {cmdSetName, cmdSetText, cmdSet},
+    {cmdSaveName, cmdSaveText, cmdSave},
+    {cmdLoadName, cmdLoadText, cmdLoad},
+    {cmdResetName, cmdResetText, cmdResetScores},
+    {cmdBuzzerName, cmdBuzzerText, cmdBuzzer},
+    {cmdAutoName, cmdAutoText, cmdAutoLight},
+    {cmdLightName, cmdLightText, cmdLight},
+    {cmdAmbientName, cmdAmbientText, cmdAmbient},
+    {cmdDebugName, cmdDebugText, cmdDebug},
+    {cmdDutyName, cmdDutyText, cmdDuty}
+};
+
+SerialShell shell(shellCommands, sizeof(shellCommands) / sizeof(shellCommands[0]));
+
+void cmdHelp(char*) {
+    shell.printHelp();
 }
 
 void setup() {
@@ -295,9 +488,10 @@ void setup() {
     pinMode(JOYSTICK_X_AXIS_PIN, INPUT);
     pinMode(JOYSTICK_Y_AXIS_PIN, INPUT);
     
-    // Setup interrupts
-    attachInterrupt(digitalPinToInterrupt(JOYSTICK_BUTTON_PIN), selectButtonISR, FALLING);
-    attachInterrupt(digitalPinToInterrupt(PAUSE_BUTTON_PIN), pauseButtonISR, FALLING);
+    // Setup interrupts (both edges, so releases and long presses can be told apart)
+    buttonEvents.setHandler(handleButtonEvent);
+    attachInterrupt(digitalPinToInterrupt(JOYSTICK_BUTTON_PIN), selectButtonISR, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(PAUSE_BUTTON_PIN), pauseButtonISR, CHANGE);
     
     // Initialize LCD and create custom characters
     if (USE_LCD_RENDERER) {
@@ -307,49 +501,62 @@ void setup() {
         lcd.createChar(EntityType::LADDER_ENTITY, ladderCharacter);
         lcd.createChar(EntityType::CUP_ENTITY, cupCharacter);
         
-        activeRenderer = &lcdRenderer;
+        compositeRenderer.addRenderer(&lcdRenderer, LCD_FRAME_INTERVAL);
         Serial.println(F("Using LCD Renderer"));
-    } else {
-        activeRenderer = &serialRenderer;
+    }
+    
+    if (USE_SERIAL_MIRROR || !USE_LCD_RENDERER) {
+        compositeRenderer.addRenderer(&serialRenderer, SERIAL_FRAME_INTERVAL);
         Serial.println(F("Using Serial Renderer"));
     }
     
-    // Initialize renderer
+    // Initialize renderers
     activeRenderer->initialize();
     
     // Initialize game controller (which initializes hardware and loads highscores)
     gameController.initialize();
     
+    // Register tunable parameters and restore saved values
+    registerParams();
+    if (params.loadFromEEPROM(PARAMS_EEPROM_ADDRESS)) {
+        Serial.println(F("Parameters loaded from EEPROM"));
+    }
+    
     // Initial render
     activeRenderer->clear();
     renderCurrentState();
     
+    resetDutyWindow();
+    
     Serial.println(F("Setup complete! Game ready."));
-    Serial.println(F("Type 'h' for help commands"));
+    Serial.println(F("Type 'help' for commands"));
 }
 
 void loop() {
-    // Process interrupt flags
-    if (selectButtonPressed) {
-        selectButtonPressed = false;
-        gameController.handleSelectButton();
-    }
-    
-    if (pauseButtonPressed) {
-        pauseButtonPressed = false;
-        gameController.handlePauseButton();
-    }
+    // Drain button edges recorded by the ISRs (debounced, dispatched to handleButtonEvent)
+    buttonEvents.update();
     
     // Handle serial commands (optional debugging)
-    handleSerialCommands();
+    shell.update();
     
     // Update game controller (handles input, game logic, hardware)
     gameController.update();
     
-    // Render current state (throttled to RENDER_INTERVAL)
+    // Render current state (throttled to renderInterval)
     renderCurrentState();
     
     // Optional: Print debug info (throttled to 2 seconds)
     // Uncomment the line below to enable debug output
     // printDebugInfo();
+    
+    // Sleep until the next game update or render is due
+    if (idleSleepEnabled) {
+        unsigned long nextDueTime = gameController.getNextUpdateTime();
+        unsigned long nextRenderTime = lastRenderTime + renderInterval;
+        
+        if ((long)(nextRenderTime - nextDueTime) < 0) {
+            nextDueTime = nextRenderTime;
+        }
+        idleUntil(nextDueTime);
+    }
 }
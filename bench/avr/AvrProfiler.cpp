@@ -0,0 +1,491 @@
+// AvrProfiler.cpp
+// Runs a firmware ELF under simavr (ATmega328P @ 16 MHz), plays a stimulus
+// script into its pins and reports where the cycles went as JSON:
+//   - self cycles and call count per function (from an avr-nm symbol list);
+//     a call is an entry reached from call/rcall/icall/eicall, so tail calls
+//     (jmp/rjmp into a function) and loops back to the entry don't count
+//   - loop() pass count, mean and worst-case pass time
+//   - per interrupt vector: count, worst/mean latency (flag raised -> vector
+//     entered) and worst-case time spent in the handler
+//
+//   avr_profiler firmware.elf symbols.txt stimuli.txt run_ms [--serial]
+//
+// symbols.txt is "avr-nm --print-size --defined-only -C" output; profile.py
+// generates it. The stimulus format matches the host runner's scripts.
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_irq.h>
+#include <simavr/sim_interrupts.h>
+#include <simavr/sim_cycle_timers.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_adc.h>
+#include <simavr/avr_uart.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint32_t CPU_FREQUENCY = 16000000;
+const uint32_t FLASH_SIZE = 32768;
+const int VECTOR_COUNT = 26;
+const uint32_t SERIAL_BYTE_SPACING_US = 1100; // One byte at 9600 baud
+
+// HC-SR04: echo starts ~450us after the trigger pulse ends
+const uint32_t ECHO_DELAY_US = 450;
+const uint32_t TRIGGER_MIN_CYCLES = 8 * (CPU_FREQUENCY / 1000000);
+const uint32_t TRIGGER_MAX_CYCLES = 20 * (CPU_FREQUENCY / 1000000);
+
+const char* const VECTOR_NAMES[VECTOR_COUNT] = {
+    "RESET", "INT0", "INT1", "PCINT0", "PCINT1", "PCINT2", "WDT",
+    "TIMER2_COMPA", "TIMER2_COMPB", "TIMER2_OVF", "TIMER1_CAPT",
+    "TIMER1_COMPA", "TIMER1_COMPB", "TIMER1_OVF", "TIMER0_COMPA",
+    "TIMER0_COMPB", "TIMER0_OVF", "SPI_STC", "USART_RX", "USART_UDRE",
+    "USART_TX", "ADC", "EE_READY", "ANALOG_COMP", "TWI", "SPM_READY"
+};
+
+// Profile Data
+struct FunctionStats {
+    std::string name;
+    uint32_t address;
+    uint32_t size;
+    uint64_t selfCycles;
+    uint64_t calls;
+};
+
+struct VectorStats {
+    uint64_t count;
+    uint64_t raisedAt;
+    bool raised;
+    uint64_t latencyTotal;
+    uint64_t latencyMax;
+    uint64_t enteredAt;
+    uint64_t handlerMax;
+};
+
+struct StimulusEvent {
+    uint64_t timeMicros;
+    std::string command;
+    std::string pin;
+    std::string value;
+};
+
+struct Profiler {
+    avr_t* avr;
+    std::vector<FunctionStats> functions;
+    std::vector<int16_t> owner; // Function index per flash word, -1 = unknown
+    uint64_t unknownCycles;
+    uint64_t sleepCycles;
+    uint32_t previousPc;
+
+    uint32_t loopAddress;
+    uint64_t loopPasses;
+    uint64_t loopStart;
+    uint64_t loopTotal;
+    uint64_t loopMax;
+
+    VectorStats vectors[VECTOR_COUNT];
+
+    // Ultrasonic responder
+    bool echoEnabled;
+    std::string echoPin;
+    uint32_t echoWidthMicros;
+    uint64_t outputHighSince[3][8];
+
+    bool echoSerial;
+};
+
+Profiler profiler;
+
+// Pin Helpers
+bool parsePin(const std::string& name, char& port, int& bit) {
+    int pin;
+    if (name.size() == 2 && (name[0] == 'A' || name[0] == 'a')) {
+        pin = 14 + (name[1] - '0');
+    } else {
+        pin = atoi(name.c_str());
+    }
+
+    if (pin < 0 || pin > 19) return false;
+    port = (pin < 8) ? 'D' : ((pin < 14) ? 'B' : 'C');
+    bit = (pin < 8) ? pin : ((pin < 14) ? pin - 8 : pin - 14);
+    return true;
+}
+
+void drivePin(const std::string& name, const std::string& level) {
+    char port;
+    int bit;
+    if (!parsePin(name, port, bit)) return;
+
+    // "z" releases the pin; the buttons all use INPUT_PULLUP, so that reads high
+    uint32_t value = (level == "0") ? 0 : 1;
+    avr_raise_irq(avr_io_getirq(profiler.avr, AVR_IOCTL_IOPORT_GETIRQ(port), bit), value);
+}
+
+void driveAnalog(const std::string& name, int value) {
+    char port;
+    int bit;
+    if (!parsePin(name, port, bit) || port != 'C') return;
+
+    // simavr's ADC takes millivolts
+    uint32_t millivolts = (uint32_t)value * 5000 / 1023;
+    avr_raise_irq(avr_io_getirq(profiler.avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + bit), millivolts);
+}
+
+// Serial
+avr_cycle_count_t sendSerialByte(avr_t* avr, avr_cycle_count_t when, void* param) {
+    (void)when;
+    std::string* pending = (std::string*)param;
+    if (pending->empty()) {
+        delete pending;
+        return 0;
+    }
+
+    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT),
+                  (uint8_t)(*pending)[0]);
+    pending->erase(0, 1);
+    return avr->cycle + avr_usec_to_cycles(avr, SERIAL_BYTE_SPACING_US);
+}
+
+void serialOutput(avr_irq_t* irq, uint32_t value, void* param) {
+    (void)irq;
+    (void)param;
+    if (profiler.echoSerial) fputc((int)value, stderr);
+}
+
+// Ultrasonic Echo
+avr_cycle_count_t endEcho(avr_t* avr, avr_cycle_count_t when, void* param) {
+    (void)avr;
+    (void)when;
+    (void)param;
+    drivePin(profiler.echoPin, "0");
+    return 0;
+}
+
+avr_cycle_count_t startEcho(avr_t* avr, avr_cycle_count_t when, void* param) {
+    (void)when;
+    (void)param;
+    drivePin(profiler.echoPin, "1");
+    avr_cycle_timer_register_usec(avr, profiler.echoWidthMicros, endEcho, nullptr);
+    return 0;
+}
+
+// Any 8-20us high pulse on an output pin counts as a trigger
+void outputChanged(avr_irq_t* irq, uint32_t value, void* param) {
+    (void)irq;
+    intptr_t id = (intptr_t)param;
+    int port = (int)(id >> 3);
+    int bit = (int)(id & 7);
+    uint64_t& highSince = profiler.outputHighSince[port][bit];
+
+    if (value) {
+        highSince = profiler.avr->cycle;
+        return;
+    }
+    if (!profiler.echoEnabled || highSince == 0) return;
+
+    uint64_t width = profiler.avr->cycle - highSince;
+    highSince = 0;
+    if (width >= TRIGGER_MIN_CYCLES && width <= TRIGGER_MAX_CYCLES && profiler.echoWidthMicros) {
+        avr_cycle_timer_register_usec(profiler.avr, ECHO_DELAY_US, startEcho, nullptr);
+    }
+}
+
+// Stimulus Script
+avr_cycle_count_t applyStimulus(avr_t* avr, avr_cycle_count_t when, void* param) {
+    (void)avr;
+    (void)when;
+    StimulusEvent* event = (StimulusEvent*)param;
+
+    if (event->command == "pin") {
+        drivePin(event->pin, event->value);
+    } else if (event->command == "analog") {
+        driveAnalog(event->pin, atoi(event->value.c_str()));
+    } else if (event->command == "pulse") {
+        profiler.echoEnabled = true;
+        profiler.echoPin = event->pin;
+        profiler.echoWidthMicros = (uint32_t)strtoul(event->value.c_str(), nullptr, 10);
+    } else if (event->command == "serial") {
+        std::string* pending = new std::string(event->pin + "\n");
+        avr_cycle_timer_register(profiler.avr, 1, sendSerialByte, pending);
+    }
+
+    delete event;
+    return 0;
+}
+
+bool loadStimuli(const char* path) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream fields(line);
+        double timeMs;
+        StimulusEvent* event = new StimulusEvent();
+        if (!(fields >> timeMs >> event->command)) {
+            delete event;
+            continue;
+        }
+        event->timeMicros = (uint64_t)(timeMs * 1000.0);
+
+        if (event->command == "serial") {
+            std::getline(fields, event->pin);
+            size_t start = event->pin.find_first_not_of(' ');
+            event->pin = (start == std::string::npos) ? "" : event->pin.substr(start);
+        } else {
+            fields >> event->pin >> event->value;
+        }
+
+        // +1us so t=0 events land after reset
+        avr_cycle_timer_register_usec(profiler.avr, (uint32_t)event->timeMicros + 1,
+                                      applyStimulus, event);
+    }
+    return true;
+}
+
+// Symbols
+bool loadSymbols(const char* path) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    profiler.owner.assign(FLASH_SIZE / 2, -1);
+
+    // "<address> <size> <type> <name...>", text symbols only
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string address, size, type;
+        if (!(fields >> address >> size >> type)) continue;
+        if (type != "T" && type != "t" && type != "W" && type != "w") continue;
+
+        std::string name;
+        std::getline(fields, name);
+        name.erase(0, name.find_first_not_of(' '));
+
+        FunctionStats function;
+        function.name = name;
+        function.address = (uint32_t)strtoul(address.c_str(), nullptr, 16);
+        function.size = (uint32_t)strtoul(size.c_str(), nullptr, 16);
+        function.selfCycles = 0;
+        function.calls = 0;
+        if (function.size == 0 || function.address + function.size > FLASH_SIZE) continue;
+
+        if (name == "loop" || name == "loop()") profiler.loopAddress = function.address;
+
+        int16_t index = (int16_t)profiler.functions.size();
+        profiler.functions.push_back(function);
+        for (uint32_t a = function.address; a < function.address + function.size; a += 2) {
+            profiler.owner[a / 2] = index;
+        }
+    }
+    return true;
+}
+
+// Interrupt Timing
+void vectorPending(avr_irq_t* irq, uint32_t value, void* param) {
+    (void)irq;
+    VectorStats& stats = profiler.vectors[(intptr_t)param];
+    if (value && !stats.raised) {
+        stats.raised = true;
+        stats.raisedAt = profiler.avr->cycle;
+    }
+}
+
+void vectorRunning(avr_irq_t* irq, uint32_t value, void* param) {
+    (void)irq;
+    VectorStats& stats = profiler.vectors[(intptr_t)param];
+
+    if (value) {
+        uint64_t latency = stats.raised ? profiler.avr->cycle - stats.raisedAt : 0;
+        stats.raised = false;
+        stats.count++;
+        stats.latencyTotal += latency;
+        stats.latencyMax = std::max(stats.latencyMax, latency);
+        stats.enteredAt = profiler.avr->cycle;
+    } else {
+        stats.handlerMax = std::max(stats.handlerMax, profiler.avr->cycle - stats.enteredAt);
+    }
+}
+
+void hookPeripherals() {
+    avr_t* avr = profiler.avr;
+
+    for (intptr_t v = 1; v < VECTOR_COUNT; v++) {
+        avr_irq_t* irq = avr_get_interrupt_irq(avr, (uint8_t)v);
+        if (irq == nullptr) continue;
+        avr_irq_register_notify(irq + AVR_INT_IRQ_PENDING, vectorPending, (void*)v);
+        avr_irq_register_notify(irq + AVR_INT_IRQ_RUNNING, vectorRunning, (void*)v);
+    }
+
+    static const char ports[] = {'B', 'C', 'D'};
+    for (intptr_t p = 0; p < 3; p++) {
+        for (intptr_t bit = 0; bit < 8; bit++) {
+            avr_irq_t* irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(ports[p]), (int)bit);
+            if (irq) avr_irq_register_notify(irq, outputChanged, (void*)((p << 3) | bit));
+        }
+    }
+
+    // Keep the UART quiet unless asked, simavr echoes it by default
+    uint32_t flags = 0;
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT),
+                            serialOutput, nullptr);
+}
+
+// Main Run Loop
+bool isCallAt(uint32_t pc) {
+    if (pc + 1 >= FLASH_SIZE) return false;
+    uint16_t opcode = (uint16_t)(profiler.avr->flash[pc] | (profiler.avr->flash[pc + 1] << 8));
+    return (opcode & 0xFE0E) == 0x940E   // call k
+        || (opcode & 0xF000) == 0xD000   // rcall k
+        || opcode == 0x9509              // icall
+        || opcode == 0x9519;             // eicall
+}
+
+void run(uint64_t endCycle) {
+    avr_t* avr = profiler.avr;
+
+    while (avr->cycle < endCycle) {
+        uint32_t pc = avr->pc;
+        uint64_t before = avr->cycle;
+        bool sleeping = (avr->state == cpu_Sleeping);
+
+        int16_t index = (pc < FLASH_SIZE) ? profiler.owner[pc / 2] : -1;
+        if (index >= 0 && profiler.functions[index].address == pc && isCallAt(profiler.previousPc)) {
+            profiler.functions[index].calls++;
+        }
+
+        if (pc == profiler.loopAddress && !sleeping) {
+            if (profiler.loopStart != 0) {
+                uint64_t pass = before - profiler.loopStart;
+                profiler.loopPasses++;
+                profiler.loopTotal += pass;
+                profiler.loopMax = std::max(profiler.loopMax, pass);
+            }
+            profiler.loopStart = before;
+        }
+
+        int state = avr_run(avr);
+        if (state == cpu_Done || state == cpu_Crashed) {
+            fprintf(stderr, "firmware stopped (state %d) at pc 0x%04x\n", state, pc);
+            break;
+        }
+        profiler.previousPc = pc;
+
+        uint64_t spent = avr->cycle - before;
+        if (sleeping) profiler.sleepCycles += spent;
+        else if (index >= 0) profiler.functions[index].selfCycles += spent;
+        else profiler.unknownCycles += spent;
+    }
+}
+
+void writeReport(FILE* out, uint64_t cycles) {
+    fprintf(out, "{\n  \"cpu_hz\": %u,\n  \"cycles\": %llu,\n  \"sleep_cycles\": %llu,\n"
+                 "  \"unattributed_cycles\": %llu,\n",
+            CPU_FREQUENCY, (unsigned long long)cycles,
+            (unsigned long long)profiler.sleepCycles,
+            (unsigned long long)profiler.unknownCycles);
+
+    fprintf(out, "  \"loop\": {\"passes\": %llu, \"mean_cycles\": %llu, \"max_cycles\": %llu},\n",
+            (unsigned long long)profiler.loopPasses,
+            (unsigned long long)(profiler.loopPasses ? profiler.loopTotal / profiler.loopPasses : 0),
+            (unsigned long long)profiler.loopMax);
+
+    fprintf(out, "  \"vectors\": {");
+    bool first = true;
+    for (int v = 1; v < VECTOR_COUNT; v++) {
+        const VectorStats& stats = profiler.vectors[v];
+        if (stats.count == 0) continue;
+        fprintf(out, "%s\n    \"%s\": {\"count\": %llu, \"mean_latency_cycles\": %llu, "
+                     "\"max_latency_cycles\": %llu, \"max_handler_cycles\": %llu}",
+                first ? "" : ",", VECTOR_NAMES[v], (unsigned long long)stats.count,
+                (unsigned long long)(stats.latencyTotal / stats.count),
+                (unsigned long long)stats.latencyMax, (unsigned long long)stats.handlerMax);
+        first = false;
+    }
+    fprintf(out, "\n  },\n");
+
+    std::vector<const FunctionStats*> sorted;
+    for (size_t i = 0; i < profiler.functions.size(); i++) {
+        if (profiler.functions[i].selfCycles) sorted.push_back(&profiler.functions[i]);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const FunctionStats* a, const FunctionStats* b) {
+        return a->selfCycles > b->selfCycles;
+    });
+
+    fprintf(out, "  \"functions\": {");
+    for (size_t i = 0; i < sorted.size(); i++) {
+        std::string name;
+        for (char c : sorted[i]->name) {
+            if (c == '"' || c == '\\') name += '\\';
+            name += c;
+        }
+        fprintf(out, "%s\n    \"%s\": {\"self_cycles\": %llu, \"calls\": %llu}",
+                i ? "," : "", name.c_str(), (unsigned long long)sorted[i]->selfCycles,
+                (unsigned long long)sorted[i]->calls);
+    }
+    fprintf(out, "\n  }\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 5) {
+        fprintf(stderr, "usage: %s firmware.elf symbols.txt stimuli.txt run_ms [--serial]\n",
+                argv[0]);
+        return 2;
+    }
+    profiler.echoSerial = (argc > 5 && !strcmp(argv[5], "--serial"));
+
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(argv[1], &firmware) != 0) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    strcpy(firmware.mmcu, "atmega328p");
+    firmware.frequency = CPU_FREQUENCY;
+
+    profiler.avr = avr_make_mcu_by_name(firmware.mmcu);
+    if (profiler.avr == nullptr) {
+        fprintf(stderr, "simavr has no atmega328p core\n");
+        return 1;
+    }
+    avr_init(profiler.avr);
+    avr_load_firmware(profiler.avr, &firmware);
+    profiler.avr->vcc = profiler.avr->avcc = profiler.avr->aref = 5000;
+
+    if (!loadSymbols(argv[2])) {
+        fprintf(stderr, "cannot read symbols %s\n", argv[2]);
+        return 1;
+    }
+    if (profiler.loopAddress == 0) {
+        fprintf(stderr, "warning: no loop() symbol, loop timing disabled\n");
+    }
+
+    hookPeripherals();
+    if (!loadStimuli(argv[3])) {
+        fprintf(stderr, "cannot read stimuli %s\n", argv[3]);
+        return 1;
+    }
+
+    uint64_t endCycle = strtoull(argv[4], nullptr, 10) * (CPU_FREQUENCY / 1000);
+    run(endCycle);
+    writeReport(stdout, profiler.avr->cycle);
+    return 0;
+}
@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""Build each project for the ATmega328P, profile it under simavr and
+compare against a stored baseline.
+
+    bench/avr/profile.py                       # build + profile all projects
+    bench/avr/profile.py -p 4 -p 5 --save      # store baselines for 4 and 5
+    bench/avr/profile.py --compare             # diff against the baselines
+
+Needs arduino-cli (with the arduino:avr core), avr-nm and the avr_profiler
+binary, which the host CMake build produces when simavr is installed.
+Results go to bench/avr/results/, baselines to bench/avr/baselines/. No
+baselines are checked in yet: run --save on a machine with that toolchain
+and commit the files; --compare fails for a project without one.
+"""
+
+import argparse
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+BENCH = os.path.join(ROOT, "bench", "avr")
+BUILD = os.path.join(BENCH, "build")
+RESULTS = os.path.join(BENCH, "results")
+BASELINES = os.path.join(BENCH, "baselines")
+
+FQBN = "arduino:avr:uno"
+CPU_HZ = 16000000
+
+# Functions that the compiler would otherwise inline into their only caller
+# (loop() into main() in particular) stay visible to the profiler
+PROFILE_FLAGS = "-fno-inline-functions-called-once"
+
+# Sources per project, staged into an arduino-cli sketch folder
+PROJECTS = {
+    1: ["Project_1/RGBLedControl.ino"],
+    2: ["Project_2/TrafficLightControl.ino"],
+    3: ["Project_3/AlarmSystem.ino"],
+    4: ["Project_4/SimonSays.cpp"],
+    5: ["Project_5/code/src/main.cpp", "Project_5/code/lib/*/*.cpp", "Project_5/code/lib/*/*.hpp"],
+}
+
+
+def run(command, **kwargs):
+    print("+ " + " ".join(command), file=sys.stderr)
+    return subprocess.run(command, check=True, **kwargs)
+
+
+def stage_sketch(project):
+    """Copy a project into a flat sketch folder arduino-cli can build."""
+    name = "project%d" % project
+    sketch = os.path.join(BUILD, name, name)
+    shutil.rmtree(sketch, ignore_errors=True)
+    os.makedirs(sketch)
+
+    has_ino = False
+    for pattern in PROJECTS[project]:
+        for source in sorted(glob.glob(os.path.join(ROOT, pattern))):
+            if source.endswith(".ino"):
+                shutil.copy(source, os.path.join(sketch, name + ".ino"))
+                has_ino = True
+            else:
+                shutil.copy(source, sketch)
+
+    if not has_ino:
+        with open(os.path.join(sketch, name + ".ino"), "w") as ino:
+            ino.write("// Sources are the .cpp files in this folder\n")
+    return sketch
+
+
+def build(project):
+    sketch = stage_sketch(project)
+    output = os.path.join(BUILD, "project%d" % project, "out")
+    run([
+        "arduino-cli", "compile", "--fqbn", FQBN,
+        "--library", os.path.join(ROOT, "libraries", "FastPin"),
+        "--library", os.path.join(ROOT, "libraries", "ShiftDisplay"),
+        "--library", os.path.join(ROOT, "libraries", "PackedSequence"),
+        "--library", os.path.join(ROOT, "libraries", "StateMachine"),
+        "--library", os.path.join(ROOT, "libraries", "Xorshift"),
+        "--library", os.path.join(ROOT, "libraries", "DifficultyController"),
+        "--library", os.path.join(ROOT, "libraries", "GameRecords"),
+        "--library", os.path.join(ROOT, "libraries", "ToneQueue"),
+        "--library", os.path.join(ROOT, "libraries", "DistanceFilter"),
+        "--build-property", "compiler.cpp.extra_flags=" + PROFILE_FLAGS,
+        "--build-property", "compiler.c.elf.extra_flags=" + PROFILE_FLAGS,
+        "--output-dir", output, sketch,
+    ])
+
+    elf = os.path.join(output, os.path.basename(sketch) + ".ino.elf")
+    symbols = os.path.join(output, "symbols.txt")
+    with open(symbols, "w") as out:
+        run(["avr-nm", "--print-size", "--defined-only", "-C", elf], stdout=out)
+    return elf, symbols
+
+
+def profile(project, profiler, run_ms, serial):
+    elf, symbols = build(project)
+    stimuli = os.path.join(BENCH, "stimuli", "project%d.txt" % project)
+
+    command = [profiler, elf, symbols, stimuli, str(run_ms)]
+    if serial:
+        command.append("--serial")
+    result = json.loads(run(command, stdout=subprocess.PIPE).stdout)
+
+    result["project"] = project
+    result["run_ms"] = run_ms
+    result["commit"] = git_commit()
+
+    os.makedirs(RESULTS, exist_ok=True)
+    with open(os.path.join(RESULTS, "project%d.json" % project), "w") as out:
+        json.dump(result, out, indent=2)
+    return result
+
+
+def git_commit():
+    try:
+        return subprocess.run(["git", "-C", ROOT, "rev-parse", "--short", "HEAD"],
+                              check=True, stdout=subprocess.PIPE,
+                              universal_newlines=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def micros(cycles):
+    return cycles * 1e6 / CPU_HZ
+
+
+def summarize(result, top):
+    loop = result["loop"]
+    busy = result["cycles"] - result["sleep_cycles"]
+    print("Project %d @ %s: %d loop passes, mean %.1f us, worst %.1f us, CPU busy %.1f%%" % (
+        result["project"], result["commit"], loop["passes"], micros(loop["mean_cycles"]),
+        micros(loop["max_cycles"]), 100.0 * busy / max(result["cycles"], 1)))
+
+    for name, stats in result["vectors"].items():
+        print("  ISR %-13s %8d calls, latency mean %5.2f us / worst %5.2f us, handler worst %6.2f us" % (
+            name, stats["count"], micros(stats["mean_latency_cycles"]),
+            micros(stats["max_latency_cycles"]), micros(stats["max_handler_cycles"])))
+
+    functions = list(result["functions"].items())[:top]
+    for name, stats in functions:
+        print("  %6.2f%% %12d cycles %9d calls  %s" % (
+            100.0 * stats["self_cycles"] / max(busy, 1), stats["self_cycles"], stats["calls"], name))
+
+
+def compare(result, baseline, threshold, top):
+    """Print the deltas; returns True when something regressed past threshold."""
+    regressed = False
+
+    def check(label, old, new):
+        nonlocal regressed
+        change = 100.0 * (new - old) / old if old else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "  <-- regression"
+            regressed = True
+        print("  %-40s %12d -> %12d  %+6.1f%%%s" % (label, old, new, change, flag))
+
+    print("Project %d: %s -> %s" % (result["project"], baseline["commit"], result["commit"]))
+    check("loop mean cycles", baseline["loop"]["mean_cycles"], result["loop"]["mean_cycles"])
+    check("loop worst cycles", baseline["loop"]["max_cycles"], result["loop"]["max_cycles"])
+
+    for name, stats in result["vectors"].items():
+        old = baseline["vectors"].get(name)
+        if old:
+            check("ISR %s worst latency" % name, old["max_latency_cycles"], stats["max_latency_cycles"])
+            check("ISR %s worst handler" % name, old["max_handler_cycles"], stats["max_handler_cycles"])
+
+    for name, stats in list(baseline["functions"].items())[:top]:
+        new = result["functions"].get(name, {"self_cycles": 0})
+        check(name[:40], stats["self_cycles"], new["self_cycles"])
+    return regressed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-p", "--project", type=int, action="append", choices=sorted(PROJECTS),
+                        help="project number (repeatable, default: all)")
+    parser.add_argument("--profiler", default=os.path.join(ROOT, "build", "avr_profiler"),
+                        help="path to the avr_profiler binary")
+    parser.add_argument("--ms", type=int, default=5000, help="simulated run time per project")
+    parser.add_argument("--top", type=int, default=15, help="functions to list")
+    parser.add_argument("--serial", action="store_true", help="echo the firmware's Serial output")
+    parser.add_argument("--save", action="store_true", help="store the results as the new baseline")
+    parser.add_argument("--compare", action="store_true", help="diff against the stored baseline")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="percent increase that counts as a regression (default 5)")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.profiler):
+        parser.error("no avr_profiler at %s (it is only built when simavr is installed)" % args.profiler)
+
+    regressed = False
+    missing = []
+    for project in args.project or sorted(PROJECTS):
+        result = profile(project, args.profiler, args.ms, args.serial)
+        summarize(result, args.top)
+
+        baseline_path = os.path.join(BASELINES, "project%d.json" % project)
+        if args.compare:
+            if os.path.exists(baseline_path):
+                with open(baseline_path) as baseline:
+                    regressed |= compare(result, json.load(baseline), args.threshold, args.top)
+            else:
+                print("  no baseline for project %d, run with --save first" % project)
+                missing.append(project)
+
+        if args.save:
+            os.makedirs(BASELINES, exist_ok=True)
+            shutil.copy(os.path.join(RESULTS, "project%d.json" % project), baseline_path)
+        print()
+
+    if missing:
+        print("missing baselines: %s" % ", ".join("project%d" % p for p in missing), file=sys.stderr)
+    return 1 if regressed or missing else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
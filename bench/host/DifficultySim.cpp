@@ -0,0 +1,140 @@
+// DifficultySim.cpp
+// Simon Says difficulty controller against synthetic players, on the host.
+//
+//   ./build/difficulty_sim [rounds]
+//
+// Each player remembers a symbol shown for t ms with probability
+// 1 - exp(-t / recallTime), and every symbol beyond their span costs another
+// 20%. A round needs the whole sequence right; a win grows the sequence by
+// one, a loss starts a new game at the controller's start length, like the
+// sketch. Telemetry (first input, answer time, extra character cycles) is
+// drawn around each player's habits, slower when recall is shaky.
+//
+// A confident win adds (100 - target) credit and a loss takes target away, so
+// the level settles where target percent of rounds are won. Hesitant wins
+// count for less, which moves a hesitant player's balance point up to
+// target / (target + average win credit). Each player passes when the win
+// rate over the last half of the run is within tolerance of that balance
+// point, or the level sits at the bound the player is pushing against.
+//
+// Exits non-zero if a player fails.
+
+#include <Arduino.h>
+#include <DifficultyController.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+// Same configuration as Project_4/SimonSays.cpp
+const DifficultyConfig config = {75, 200, 4000, 1000, 500, 4, 3000, 4000, 8};
+
+const int windowRounds = 100;
+const double tolerance = 8.0; // Percentage points
+
+struct Player {
+    const char* name;
+    double recallTime;    // ms of display for 63% recall
+    int span;             // Symbols held without extra loss
+    double entryTime;     // ms per symbol entered
+    double firstInput;    // ms before the first input
+    double extraCycles;   // Spare character cycles per symbol
+};
+
+const Player players[] = {
+    {"novice",            1500, 4, 3500, 2500, 1.5},
+    {"average",            900, 6, 2500, 1500, 0.8},
+    {"expert",             300, 9, 1500,  800, 0.2},
+    {"slow but accurate",  500, 8, 5000, 4000, 0.3},
+};
+
+struct Window {
+    int rounds;
+    int wins;
+    double winCredit;
+};
+
+bool simulate(const Player& player, int rounds) {
+    DifficultyController difficulty(config);
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::lognormal_distribution<double> noise(0.0, 0.25);
+
+    int length = difficulty.getStartLength();
+    Window window = {0, 0, 0};
+    Window late = {0, 0, 0};
+
+    std::printf("%s\n", player.name);
+    std::printf("  %8s %6s %6s %10s %8s\n", "rounds", "won %", "level", "ms/symbol", "start");
+
+    for (int round = 1; round <= rounds; round++) {
+        double recall = 1.0 - std::exp(-(double)difficulty.getSymbolTime() / player.recallTime);
+        double chance = std::pow(recall, length);
+        if (length > player.span) chance *= std::pow(0.8, length - player.span);
+        bool won = uniform(rng) < chance;
+
+        // Hesitation grows as recall gets shaky
+        double unsure = 1.5 - recall;
+        RoundTelemetry telemetry;
+        telemetry.firstInputTime = (unsigned long)(player.firstInput * unsure * noise(rng));
+        telemetry.symbols = (uint16_t)length;
+        telemetry.submitTime = telemetry.firstInputTime +
+                               (unsigned long)(length * player.entryTime * unsure * noise(rng));
+        telemetry.extraCycles = (uint16_t)std::lround(length * player.extraCycles * unsure * noise(rng));
+
+        double winCredit = (100 - config.targetSuccess) * (4 - difficulty.hesitation(telemetry)) / 4;
+        difficulty.recordRound(won, telemetry);
+        length = won ? length + 1 : difficulty.getStartLength();
+
+        window.rounds++;
+        window.wins += won;
+        if (round > rounds / 2) {
+            late.rounds++;
+            late.wins += won;
+            if (won) late.winCredit += winCredit;
+        }
+        if (window.rounds == windowRounds || round == rounds) {
+            std::printf("  %8d %6.1f %6u %10u %8u\n", round, 100.0 * window.wins / window.rounds,
+                        difficulty.getLevel(), difficulty.getSymbolTime(), difficulty.getStartLength());
+            window = {0, 0, 0};
+        }
+    }
+
+    double rate = 100.0 * late.wins / late.rounds;
+    double averageWinCredit = late.wins > 0 ? late.winCredit / late.wins : 100 - config.targetSuccess;
+    double balance = 100.0 * config.targetSuccess / (config.targetSuccess + averageWinCredit);
+
+    bool pass = std::fabs(rate - balance) <= tolerance;
+    const char* reason = "converged";
+    if (!pass && rate > balance && difficulty.getLevel() == difficulty.getMaxLevel()) {
+        pass = true;
+        reason = "hardest level";
+    } else if (!pass && rate < balance && difficulty.getLevel() == 0) {
+        pass = true;
+        reason = "easiest level";
+    }
+    std::printf("  last %d rounds: %.1f%% won, balance point %.1f%%  %s (%s)\n\n", late.rounds, rate,
+                balance, pass ? "ok" : "FAIL", pass ? reason : "off target");
+    return pass;
+}
+
+} // namespace
+
+// Sketch entry points the core expects (unused here)
+void setup() {}
+void loop() {}
+
+int main(int argc, char** argv) {
+    int rounds = (argc > 1) ? std::atoi(argv[1]) : 2000;
+    if (rounds < 2 * windowRounds) rounds = 2 * windowRounds;
+
+    std::printf("target %u%% of rounds won, %d rounds per player\n\n", config.targetSuccess, rounds);
+    bool pass = true;
+    for (const Player& player : players) {
+        pass &= simulate(player, rounds);
+    }
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// PrngBench.cpp
+// Simon Says sequence generator (Xorshift32::nextBelow) against the core's
+// random(howBig): statistical quality and speed, on the host.
+//
+//   ./build/prng_bench [samples]
+//
+// Quality checks, chi-square against the 1% critical value:
+//   - symbol frequency over the 19 charSet symbols
+//   - successive symbol pairs (19 x 19 buckets)
+//   - every output bit set about half the time
+//   - challenge codes: first symbol of all 10000 games, and how many games
+//     share their first 8 symbols with another code
+// Speed is host nanoseconds per call, which only ranks the two generators;
+// AVR cycle counts come from bench/avr/profile.py.
+//
+// Exits non-zero if the xorshift generator fails a check.
+
+#include <Arduino.h>
+#include <Xorshift.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+namespace {
+
+const int symbolCount = 19; // charSetSize in Project_4
+const unsigned int challengeCodeCount = 10000;
+const int challengePrefixLength = 8;
+
+Xorshift32 generator;
+
+uint16_t xorshiftBelow(uint16_t bound) {
+    return generator.nextBelow(bound);
+}
+
+uint16_t randomBelow(uint16_t bound) {
+    return (uint16_t)random(bound);
+}
+
+uint32_t xorshiftRaw() {
+    return generator.next();
+}
+
+uint32_t randomRaw() {
+    return (uint32_t)random(0x7FFFFFFFL);
+}
+
+struct Source {
+    const char* name;
+    uint16_t (*below)(uint16_t bound);
+    uint32_t (*raw)();
+    int rawBits;
+    void (*reseed)();
+};
+
+void reseedXorshift() {
+    generator.setSeed(Xorshift32::seedFromCode(1));
+}
+
+void reseedRandom() {
+    randomSeed(1);
+}
+
+const Source sources[] = {
+    {"xorshift32", xorshiftBelow, xorshiftRaw, 32, reseedXorshift},
+    {"random()", randomBelow, randomRaw, 31, reseedRandom},
+};
+
+// Wilson-Hilferty approximation of the 99th percentile
+double chiSquareCritical(int degrees) {
+    const double z = 2.3263;
+    double k = 2.0 / (9.0 * degrees);
+    return degrees * std::pow(1.0 - k + z * std::sqrt(k), 3.0);
+}
+
+double chiSquare(const std::vector<unsigned long>& counts, double expected) {
+    double sum = 0;
+    for (unsigned long count : counts) {
+        double difference = count - expected;
+        sum += difference * difference / expected;
+    }
+    return sum;
+}
+
+bool report(const char* check, double value, double limit) {
+    bool pass = value <= limit;
+    std::printf("  %-28s %12.1f  (limit %8.1f)  %s\n", check, value, limit, pass ? "ok" : "FAIL");
+    return pass;
+}
+
+bool checkQuality(const Source& source, unsigned long samples) {
+    bool pass = true;
+    source.reseed();
+
+    // Symbol and pair frequencies from one stream
+    std::vector<unsigned long> singles(symbolCount, 0);
+    std::vector<unsigned long> pairs(symbolCount * symbolCount, 0);
+    uint16_t previous = source.below(symbolCount);
+    for (unsigned long i = 0; i < samples; i++) {
+        uint16_t symbol = source.below(symbolCount);
+        singles[symbol]++;
+        pairs[previous * symbolCount + symbol]++;
+        previous = symbol;
+    }
+    pass &= report("symbol frequency", chiSquare(singles, (double)samples / symbolCount),
+                   chiSquareCritical(symbolCount - 1));
+    pass &= report("successive pairs",
+                   chiSquare(pairs, (double)samples / (symbolCount * symbolCount)),
+                   chiSquareCritical(symbolCount * symbolCount - 1));
+
+    // Worst single output bit (1 degree of freedom each)
+    double worstBit = 0;
+    std::vector<unsigned long> ones(source.rawBits, 0);
+    for (unsigned long i = 0; i < samples; i++) {
+        uint32_t value = source.raw();
+        for (int bit = 0; bit < source.rawBits; bit++) {
+            ones[bit] += (value >> bit) & 1;
+        }
+    }
+    for (int bit = 0; bit < source.rawBits; bit++) {
+        double difference = ones[bit] - samples / 2.0;
+        worstBit = std::max(worstBit, 4.0 * difference * difference / samples);
+    }
+    // Bonferroni: 1% over all the bits together
+    pass &= report("worst bit balance", worstBit, 6.635 + 2.0 * std::log((double)source.rawBits));
+    return pass;
+}
+
+bool checkChallengeCodes() {
+    bool pass = true;
+    std::vector<unsigned long> firstSymbols(symbolCount, 0);
+    std::set<unsigned long long> prefixes;
+
+    for (unsigned int code = 0; code < challengeCodeCount; code++) {
+        Xorshift32 game(Xorshift32::seedFromCode(code));
+        unsigned long long prefix = 0;
+        for (int i = 0; i < challengePrefixLength; i++) {
+            uint16_t symbol = game.nextBelow(symbolCount);
+            if (i == 0) firstSymbols[symbol]++;
+            prefix = prefix * symbolCount + symbol;
+        }
+        prefixes.insert(prefix);
+    }
+
+    pass &= report("first symbol over codes",
+                   chiSquare(firstSymbols, (double)challengeCodeCount / symbolCount),
+                   chiSquareCritical(symbolCount - 1));
+    // 10000 codes over 19^8 prefixes: a shared prefix is already very unlikely
+    pass &= report("codes sharing 8-symbol prefix", challengeCodeCount - prefixes.size(), 2);
+    return pass;
+}
+
+double nanosecondsPerCall(const Source& source, unsigned long samples) {
+    source.reseed();
+    volatile uint16_t sink = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint16_t sum = 0;
+    for (unsigned long i = 0; i < samples; i++) {
+        sum += source.below(symbolCount);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    sink = sum;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / samples;
+}
+
+} // namespace
+
+// Sketch entry points the core expects (unused here)
+void setup() {}
+void loop() {}
+
+int main(int argc, char** argv) {
+    unsigned long samples = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 2000000UL;
+    if (samples < 1000) samples = 1000;
+
+    bool xorshiftPass = true;
+    for (const Source& source : sources) {
+        std::printf("%s, %lu samples\n", source.name, samples);
+        bool pass = checkQuality(source, samples);
+        if (&source == &sources[0]) xorshiftPass = pass;
+    }
+
+    std::printf("challenge codes (xorshift32, %u codes)\n", challengeCodeCount);
+    xorshiftPass &= checkChallengeCodes();
+
+    std::printf("speed, nextBelow(%d) vs random(%d)\n", symbolCount, symbolCount);
+    for (const Source& source : sources) {
+        std::printf("  %-28s %8.2f ns/call\n", source.name, nanosecondsPerCall(source, samples));
+    }
+
+    return xorshiftPass ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// Arduino.h (host)
+// Host stand-in for the Arduino AVR core, enough to build and run every
+// project on a workstation. Time is virtual: it only moves when the sketch
+// calls into the core (each call has a cost modelled on an Uno at 16 MHz),
+// sleeps, or when the runner steps between loop() calls. Inputs are driven
+// from a script and outputs are recorded, see HostSim.hpp.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <math.h>
+#include <type_traits>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "binary.h"
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+// Pin Levels and Modes
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+// Interrupt Modes
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+// Uno Pin Map
+static const uint8_t A0 = 14;
+static const uint8_t A1 = 15;
+static const uint8_t A2 = 16;
+static const uint8_t A3 = 17;
+static const uint8_t A4 = 18;
+static const uint8_t A5 = 19;
+static const uint8_t LED_BUILTIN = 13;
+static const uint8_t SS = 10;
+static const uint8_t MOSI = 11;
+static const uint8_t MISO = 12;
+static const uint8_t SCK = 13;
+#define NUM_DIGITAL_PINS 20
+
+#define NOT_A_PIN 0
+#define NOT_A_PORT 0
+#define NOT_AN_INTERRUPT -1
+#define NOT_ON_TIMER 0
+#define PB 2
+#define PC 3
+#define PD 4
+
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+#define digitalPinToPort(p) ((p) < 8 ? PD : ((p) < 14 ? PB : ((p) < 20 ? PC : NOT_A_PIN)))
+#define digitalPinToBitMask(p) ((uint8_t)_BV((p) < 8 ? (p) : ((p) < 14 ? (p) - 8 : (p) - 14)))
+#define digitalPinToTimer(p) (((p) == 3 || (p) == 5 || (p) == 6 || (p) == 9 || \
+                               (p) == 10 || (p) == 11) ? (p) : NOT_ON_TIMER)
+#define digitalPinToPCICR(p) (&PCICR)
+#define digitalPinToPCICRbit(p) ((p) < 8 ? 2 : ((p) < 14 ? 0 : 1))
+#define digitalPinToPCMSK(p) ((p) < 8 ? &PCMSK2 : ((p) < 14 ? &PCMSK0 : &PCMSK1))
+#define digitalPinToPCMSKbit(p) ((p) < 8 ? (p) : ((p) < 14 ? (p) - 8 : (p) - 14))
+
+volatile uint8_t* portOutputRegister(uint8_t port);
+volatile uint8_t* portInputRegister(uint8_t port);
+volatile uint8_t* portModeRegister(uint8_t port);
+
+// Bit Helpers
+#define lowByte(w) ((uint8_t)((w) & 0xFF))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b) (1UL << (b))
+
+// Math Helpers (templates instead of the core's macros, so std headers still work).
+// They return by value: with equal types the bare ?: type is a reference to a parameter
+template <typename T, typename U>
+inline auto min(T a, U b) -> typename std::decay<decltype(true ? a : b)>::type { return (a < b) ? a : b; }
+template <typename T, typename U>
+inline auto max(T a, U b) -> typename std::decay<decltype(true ? a : b)>::type { return (a > b) ? a : b; }
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) {
+    return (value < low) ? low : ((value > high) ? high : value);
+}
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+// Character Helpers
+inline bool isDigit(int c) { return isdigit(c) != 0; }
+inline bool isAlpha(int c) { return isalpha(c) != 0; }
+inline bool isAlphaNumeric(int c) { return isalnum(c) != 0; }
+inline bool isSpace(int c) { return isspace(c) != 0; }
+inline bool isUpperCase(int c) { return isupper(c) != 0; }
+inline bool isLowerCase(int c) { return islower(c) != 0; }
+inline bool isPrintable(int c) { return isprint(c) != 0; }
+
+// Random Numbers (same LCG as avr-libc random())
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+// Time
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Digital and Analog I/O
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000L);
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+// Interrupts
+#define interrupts() sei()
+#define noInterrupts() cli()
+void attachInterrupt(uint8_t interruptNumber, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interruptNumber);
+
+// Sketch Entry Points
+void setup(void);
+void loop(void);
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,36 @@
+// EEPROM.h (host)
+// 1 KB of emulated EEPROM, optionally persisted to a file between runs.
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+class EEPROMClass {
+public:
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value);
+    uint16_t length();
+
+    template <typename T>
+    T& get(int address, T& value) {
+        uint8_t* bytes = (uint8_t*)&value;
+        for (size_t i = 0; i < sizeof(T); i++) bytes[i] = read(address + (int)i);
+        return value;
+    }
+
+    template <typename T>
+    const T& put(int address, const T& value) {
+        const uint8_t* bytes = (const uint8_t*)&value;
+        for (size_t i = 0; i < sizeof(T); i++) update(address + (int)i, bytes[i]);
+        return value;
+    }
+
+    uint8_t operator[](int address) { return read(address); }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // HOST_EEPROM_H
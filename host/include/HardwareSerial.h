@@ -0,0 +1,27 @@
+// HardwareSerial.h (host)
+// Output goes to stdout, input comes from the runner's script. Transmit
+// time follows the begin() baud rate: a write into a full 64-byte buffer
+// waits for the wire, and flush() waits until everything is sent.
+
+#ifndef HOST_HARDWARE_SERIAL_H
+#define HOST_HARDWARE_SERIAL_H
+
+#include "Print.h"
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud);
+    void end();
+    int available();
+    int peek();
+    int read();
+    int availableForWrite();
+    void flush();
+    size_t write(uint8_t c) override;
+    using Print::write;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_HARDWARE_SERIAL_H
@@ -0,0 +1,87 @@
+// HostSim.hpp
+// Control side of the host HAL: lets the runner (or a benchmark) script the
+// inputs, step virtual time and inspect what the sketch drove.
+
+#ifndef HOST_SIM_HPP
+#define HOST_SIM_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace hostsim {
+
+// Recorded Output Events
+enum OutputKind {
+    OUTPUT_DIGITAL,  // Pin level changed (digitalWrite or a port register store)
+    OUTPUT_ANALOG,   // analogWrite duty
+    OUTPUT_TONE,     // tone() frequency, 0 = noTone()
+};
+
+struct OutputEvent {
+    unsigned long long timeMicros;
+    OutputKind kind;
+    uint8_t pin;
+    unsigned long value;
+};
+
+// Per-Call Costs (microseconds of virtual time, roughly an Uno at 16 MHz)
+struct CallCosts {
+    unsigned int millisCall = 1;
+    unsigned int microsCall = 4;
+    unsigned int digitalWriteCall = 5;
+    unsigned int digitalReadCall = 4;
+    unsigned int analogReadCall = 112;
+    unsigned int analogWriteCall = 6;
+    unsigned int serialByte = 8;     // Copy into the TX ring (the wire time is modeled separately)
+    unsigned int spiByte = 2;        // SPI at 4 MHz plus loop overhead
+    unsigned int eepromWrite = 3300; // Per changed byte
+    unsigned int loopOverhead = 3;   // Between two loop() calls
+};
+
+// Setup
+void reset();
+CallCosts& costs();
+void setEchoSerial(bool echo);       // Copy Serial output to stdout (default on)
+void setTrace(bool trace);           // Print every output event as it happens
+bool setEEPROMFile(const char* path); // Load now, write back on every change
+
+// Time
+unsigned long long now();            // Virtual microseconds since reset
+void advance(unsigned long long micros);
+void advanceTo(unsigned long long timeMicros);
+
+// Scripted Inputs (applied immediately, or at a virtual time)
+void setDigitalInput(uint8_t pin, int level); // -1 = undriven (floating)
+void setAnalogInput(uint8_t pin, int value);
+void setPulseWidth(uint8_t pin, unsigned long widthMicros); // What pulseIn() measures, 0 = timeout
+void sendSerial(const std::string& text);
+void attachUltrasonic(uint8_t triggerPin, uint8_t echoPin); // Echo answers each trigger pulse
+
+void scheduleDigitalInput(unsigned long long timeMicros, uint8_t pin, int level);
+void scheduleAnalogInput(unsigned long long timeMicros, uint8_t pin, int value);
+void schedulePulseWidth(unsigned long long timeMicros, uint8_t pin, unsigned long widthMicros);
+void scheduleSerial(unsigned long long timeMicros, const std::string& text);
+bool loadScript(const char* path);   // See SketchRunner.cpp for the format
+
+// Recorded Outputs
+int getPinLevel(uint8_t pin);
+const std::vector<OutputEvent>& outputEvents();
+void clearOutputEvents();
+const std::string& serialOutput();
+void clearSerialOutput();
+const std::vector<uint8_t>& spiCapture();
+void clearSpiCapture();
+std::string lcdRow(uint8_t row);     // Custom glyphs 0-7 show as "@#$%&*+="
+uint8_t eepromRead(int address);
+unsigned long eepromWriteCount();
+
+// Sketch Driving
+void runSetup();
+void runLoop();
+unsigned long long loopCount();
+unsigned long long sleepMicros();    // Virtual time spent in sleep_cpu()
+
+} // namespace hostsim
+
+#endif // HOST_SIM_HPP
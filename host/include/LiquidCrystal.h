@@ -0,0 +1,51 @@
+// LiquidCrystal.h (host)
+// HD44780 stand-in: writes land in a character buffer the runner can print.
+
+#ifndef HOST_LIQUID_CRYSTAL_H
+#define HOST_LIQUID_CRYSTAL_H
+
+#include <string>
+#include "Print.h"
+
+class LiquidCrystal : public Print {
+private:
+    static const uint8_t MAX_COLUMNS = 40;
+    static const uint8_t MAX_ROWS = 4;
+
+    char buffer[MAX_ROWS][MAX_COLUMNS];
+    uint8_t glyphs[8][8];
+    uint8_t columns;
+    uint8_t rows;
+    uint8_t cursorColumn;
+    uint8_t cursorRow;
+
+public:
+    LiquidCrystal(uint8_t rs, uint8_t enable,
+                  uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3);
+    LiquidCrystal(uint8_t rs, uint8_t rw, uint8_t enable,
+                  uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3);
+    LiquidCrystal(uint8_t rs, uint8_t enable,
+                  uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3,
+                  uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7);
+
+    void begin(uint8_t cols, uint8_t lines, uint8_t charsize = 0);
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void createChar(uint8_t location, uint8_t charmap[]);
+
+    void display() {}
+    void noDisplay() {}
+    void cursor() {}
+    void noCursor() {}
+    void blink() {}
+    void noBlink() {}
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    // Host only: one row as text
+    std::string hostRow(uint8_t row) const;
+};
+
+#endif // HOST_LIQUID_CRYSTAL_H
@@ -0,0 +1,51 @@
+// SPI.h (host)
+// Every transferred byte is captured for the runner; reads return 0.
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+#define SPI_CLOCK_DIV2 0x04
+#define SPI_CLOCK_DIV4 0x00
+#define SPI_CLOCK_DIV8 0x05
+#define SPI_CLOCK_DIV16 0x01
+#define SPI_CLOCK_DIV32 0x06
+#define SPI_CLOCK_DIV64 0x02
+#define SPI_CLOCK_DIV128 0x03
+
+class SPISettings {
+public:
+    SPISettings() : clock(4000000), bitOrder(1), dataMode(SPI_MODE0) {}
+    SPISettings(uint32_t clockHz, uint8_t order, uint8_t mode)
+        : clock(clockHz), bitOrder(order), dataMode(mode) {}
+
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass {
+public:
+    void begin();
+    void end();
+    void beginTransaction(const SPISettings& settings);
+    void endTransaction();
+
+    uint8_t transfer(uint8_t data);
+    void transfer(void* buffer, size_t count);
+
+    void setBitOrder(uint8_t order);
+    void setDataMode(uint8_t mode);
+    void setClockDivider(uint8_t divider);
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
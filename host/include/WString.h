@@ -0,0 +1,52 @@
+// WString.h (host)
+// The subset of Arduino's String used by the sketches.
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <string>
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+class String {
+private:
+    std::string buffer;
+
+public:
+    String(const char* text = "");
+    String(const __FlashStringHelper* text);
+    String(char c);
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+
+    unsigned int length() const;
+    const char* c_str() const;
+    char charAt(unsigned int index) const;
+    char operator[](unsigned int index) const;
+
+    String& operator=(const char* text);
+    String& operator+=(const String& other);
+    String& operator+=(const char* text);
+    String& operator+=(char c);
+
+    bool operator==(const String& other) const;
+    bool operator==(const char* text) const;
+    bool operator!=(const String& other) const;
+    bool operator!=(const char* text) const;
+    bool equals(const String& other) const;
+
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    long toInt() const;
+    int indexOf(char c) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+
+    friend String operator+(const String& left, const String& right);
+};
+
+#endif // HOST_WSTRING_H
@@ -0,0 +1,13 @@
+// avr/interrupt.h (host)
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+void sei();
+void cli();
+
+// Vectors are ordinary functions the simulator calls with interrupts disabled
+#define ISR(vector, ...) extern "C" void vector(void)
+
+#endif // HOST_AVR_INTERRUPT_H
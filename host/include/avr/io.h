@@ -0,0 +1,112 @@
+// avr/io.h (host)
+// ATmega328P registers used by the projects, backed by plain variables.
+// The simulator in HostCore.cpp watches them to drive the timers, the ADC
+// and the port pins.
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+
+// Status Register
+extern volatile uint8_t SREG;
+
+// Ports
+extern volatile uint8_t PORTB, DDRB, PINB;
+extern volatile uint8_t PORTC, DDRC, PINC;
+extern volatile uint8_t PORTD, DDRD, PIND;
+
+// Timer/Counter 0
+extern volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+#define OCIE0B 2
+#define OCIE0A 1
+#define TOIE0 0
+
+// Timer/Counter 1
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+#define WGM10 0
+#define WGM11 1
+#define COM1B0 4
+#define COM1B1 5
+#define COM1A0 6
+#define COM1A1 7
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define WGM13 4
+#define OCIE1B 2
+#define OCIE1A 1
+#define TOIE1 0
+
+// Timer/Counter 2
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+#define WGM20 0
+#define WGM21 1
+#define COM2B0 4
+#define COM2B1 5
+#define COM2A0 6
+#define COM2A1 7
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM22 3
+#define OCIE2B 2
+#define OCIE2A 1
+#define TOIE2 0
+#define OCF2B 2
+#define OCF2A 1
+#define TOV2 0
+
+// ADC
+extern volatile uint8_t ADMUX, ADCSRA, ADCSRB;
+extern volatile uint16_t ADC;
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+
+// External and Pin Change Interrupts
+extern volatile uint8_t EICRA, EIMSK, EIFR, PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+#define INT1 1
+#define INT0 0
+#define PCIE2 2
+#define PCIE1 1
+#define PCIE0 0
+
+// SPI
+extern volatile uint8_t SPCR, SPSR, SPDR;
+#define SPIE 7
+#define SPE 6
+#define DORD 5
+#define MSTR 4
+#define SPIF 7
+
+// Interrupt Vectors (weak, so unused vectors simply stay unset)
+#define HOST_VECTOR(name) extern "C" void name(void) __attribute__((weak))
+HOST_VECTOR(INT0_vect);
+HOST_VECTOR(INT1_vect);
+HOST_VECTOR(PCINT0_vect);
+HOST_VECTOR(PCINT1_vect);
+HOST_VECTOR(PCINT2_vect);
+HOST_VECTOR(TIMER2_COMPA_vect);
+HOST_VECTOR(TIMER2_COMPB_vect);
+HOST_VECTOR(TIMER2_OVF_vect);
+HOST_VECTOR(TIMER1_COMPA_vect);
+HOST_VECTOR(TIMER1_COMPB_vect);
+HOST_VECTOR(TIMER1_OVF_vect);
+HOST_VECTOR(TIMER0_COMPA_vect);
+HOST_VECTOR(TIMER0_COMPB_vect);
+HOST_VECTOR(ADC_vect);
+
+#endif // HOST_AVR_IO_H
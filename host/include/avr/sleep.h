@@ -0,0 +1,19 @@
+// avr/sleep.h (host)
+// sleep_cpu() fast-forwards virtual time to the next interrupt source.
+
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC 1
+#define SLEEP_MODE_PWR_DOWN 2
+#define SLEEP_MODE_PWR_SAVE 3
+#define SLEEP_MODE_STANDBY 6
+
+void set_sleep_mode(unsigned char mode);
+void sleep_enable();
+void sleep_disable();
+void sleep_cpu();
+void sleep_mode();
+
+#endif // HOST_AVR_SLEEP_H
@@ -0,0 +1,37 @@
+// EEPROM.cpp (host)
+#include <EEPROM.h>
+
+#include "HostInternal.hpp"
+
+EEPROMClass EEPROM;
+
+namespace {
+
+// Reads are a couple of cycles on the chip; only writes cost real time
+const unsigned int READ_MICROS = 1;
+
+bool validAddress(int address) {
+    return address >= 0 && address < hostsim::detail::EEPROM_SIZE;
+}
+
+} // namespace
+
+uint8_t EEPROMClass::read(int address) {
+    hostsim::detail::charge(READ_MICROS);
+    return validAddress(address) ? hostsim::detail::eepromData()[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (!validAddress(address)) return;
+
+    hostsim::detail::eepromData()[address] = value;
+    hostsim::detail::eepromWritten(address);
+}
+
+void EEPROMClass::update(int address, uint8_t value) {
+    if (read(address) != value) write(address, value);
+}
+
+uint16_t EEPROMClass::length() {
+    return hostsim::detail::EEPROM_SIZE;
+}
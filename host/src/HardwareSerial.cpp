@@ -0,0 +1,40 @@
+// HardwareSerial.cpp (host)
+#include <HardwareSerial.h>
+
+#include <stdio.h>
+
+#include "HostInternal.hpp"
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) {
+    hostsim::detail::serialBegin(baud);
+}
+
+void HardwareSerial::end() {}
+
+int HardwareSerial::available() {
+    return hostsim::detail::serialAvailable();
+}
+
+int HardwareSerial::peek() {
+    return hostsim::detail::serialPeek();
+}
+
+int HardwareSerial::read() {
+    return hostsim::detail::serialRead();
+}
+
+int HardwareSerial::availableForWrite() {
+    return hostsim::detail::serialAvailableForWrite();
+}
+
+void HardwareSerial::flush() {
+    hostsim::detail::serialFlush();
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    hostsim::detail::serialTransmit(c);
+    return 1;
+}
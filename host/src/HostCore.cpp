@@ -0,0 +1,938 @@
+// HostCore.cpp
+// Virtual-time ATmega328P: registers, pins, timers, ADC and interrupts.
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include <LiquidCrystal.h>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <sstream>
+
+#include "HostSim.hpp"
+#include "HostInternal.hpp"
+
+// Registers
+volatile uint8_t SREG = 0x80; // The core enables interrupts before setup()
+volatile uint8_t PORTB, DDRB, PINB;
+volatile uint8_t PORTC, DDRC, PINC;
+volatile uint8_t PORTD, DDRD, PIND;
+volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+volatile uint8_t ADMUX, ADCSRA, ADCSRB;
+volatile uint16_t ADC;
+volatile uint8_t EICRA, EIMSK, EIFR, PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t SPCR, SPSR, SPDR;
+
+namespace {
+
+const unsigned long long CYCLES_PER_MICRO = 16;
+const unsigned long long NEVER = ~0ULL;
+const unsigned long long TIMER0_PERIOD = 64 * 256;  // Core setup: prescaler 64, 8-bit overflow
+const unsigned long long ADC_CONVERSION = 13 * 128; // 13 ADC clocks at prescaler 128
+const unsigned int INTERRUPT_OVERHEAD = 4 * CYCLES_PER_MICRO; // Vector entry, register saves and reti
+const unsigned long SONAR_BURST = 460;      // us from trigger to echo rise (8 cycles at 40 kHz plus setup)
+const unsigned long SONAR_NO_ECHO = 38000;  // us the echo stays high when nothing comes back
+const unsigned int SERIAL_TX_BUFFER = 64;   // Core's TX ring; one more byte sits in the shifter
+
+// Script
+enum ScriptKind {
+    SCRIPT_DIGITAL,
+    SCRIPT_ANALOG,
+    SCRIPT_PULSE,
+    SCRIPT_SERIAL
+};
+
+struct ScriptEvent {
+    unsigned long long cycle;
+    ScriptKind kind;
+    uint8_t pin;
+    long value;
+    std::string text;
+};
+
+struct ExternalInterrupt {
+    void (*handler)(void);
+    int mode;
+};
+
+// Pending interrupt flags, in vector priority order
+enum Vector {
+    VECTOR_INT0,
+    VECTOR_INT1,
+    VECTOR_PCINT0,
+    VECTOR_PCINT1,
+    VECTOR_PCINT2,
+    VECTOR_TIMER2_COMPA,
+    VECTOR_TIMER2_OVF,
+    VECTOR_TIMER1_COMPA,
+    VECTOR_TIMER1_OVF,
+    VECTOR_TIMER0_COMPA,
+    VECTOR_ADC,
+    VECTOR_COUNT
+};
+
+// Generic timer: next compare/overflow events for the current configuration
+struct TimerModel {
+    uint8_t lastControlA;
+    uint8_t lastControlB;
+    uint16_t lastCompare;
+    unsigned long long period;     // Cycles between interrupts, 0 = stopped
+    unsigned long long nextEvent;
+};
+
+struct Simulator {
+    unsigned long long cycles;
+    bool advancing;
+    bool sleepEnabled;
+    unsigned long long sleepCycles;
+    unsigned long long loops;
+
+    std::vector<ScriptEvent> script; // Sorted by cycle
+    size_t scriptIndex;
+
+    int driveLevel[NUM_DIGITAL_PINS];
+    uint8_t pinLevel[NUM_DIGITAL_PINS];
+    int analogValue[8];
+    unsigned long pulseWidth[NUM_DIGITAL_PINS];
+    bool sonarAttached;
+    uint8_t sonarTrigger;
+    uint8_t sonarEcho;
+    int pwmDuty[NUM_DIGITAL_PINS];
+
+    uint8_t lastPINB, lastPINC, lastPIND;
+
+    ExternalInterrupt external[2];
+    bool pending[VECTOR_COUNT];
+
+    unsigned long long nextTimer0;
+    TimerModel timer1;
+    TimerModel timer2;
+    unsigned long long adcDone;
+
+    unsigned int toneFrequency;
+    uint8_t tonePin;
+    unsigned long long toneStop;
+
+    std::deque<uint8_t> serialInput;
+    std::string serialOutput;
+    unsigned long long serialByteCycles; // Wire time per byte (10 bits), 0 = before begin()
+    unsigned long long serialIdleAt;     // When the last queued byte is off the wire
+    bool echoSerial;
+    bool trace;
+
+    std::vector<hostsim::OutputEvent> outputs;
+    std::vector<uint8_t> spiBytes;
+
+    uint8_t eeprom[hostsim::detail::EEPROM_SIZE];
+    std::string eepromPath;
+    unsigned long eepromWrites;
+
+    const LiquidCrystal* lcd;
+    hostsim::CallCosts costs;
+
+    uint32_t randomState;
+};
+
+Simulator sim;
+
+// Pin <-> Port Mapping
+volatile uint8_t& portRegister(uint8_t pin) {
+    return (pin < 8) ? PORTD : ((pin < 14) ? PORTB : PORTC);
+}
+
+volatile uint8_t& ddrRegister(uint8_t pin) {
+    return (pin < 8) ? DDRD : ((pin < 14) ? DDRB : DDRC);
+}
+
+uint8_t pinMask(uint8_t pin) {
+    return digitalPinToBitMask(pin);
+}
+
+void record(hostsim::OutputKind kind, uint8_t pin, unsigned long value) {
+    hostsim::OutputEvent event;
+    event.timeMicros = sim.cycles / CYCLES_PER_MICRO;
+    event.kind = kind;
+    event.pin = pin;
+    event.value = value;
+    sim.outputs.push_back(event);
+
+    if (sim.trace) {
+        static const char* names[] = {"digital", "analog", "tone"};
+        fprintf(stderr, "[%10llu us] %-7s pin %2u = %lu\n",
+                event.timeMicros, names[kind], pin, value);
+    }
+}
+
+// Prescaler select bits to cycles per timer tick
+unsigned long long prescaler(uint8_t select, bool timer2) {
+    static const unsigned int timer01[] = {0, 1, 8, 64, 256, 1024, 0, 0};
+    static const unsigned int timer2Table[] = {0, 1, 8, 32, 64, 128, 256, 1024};
+    return timer2 ? timer2Table[select & 7] : timer01[select & 7];
+}
+
+void rescheduleTimer(TimerModel& timer, uint8_t controlA, uint8_t controlB, uint16_t compare,
+                     bool timer2) {
+    if (controlA == timer.lastControlA && controlB == timer.lastControlB &&
+        compare == timer.lastCompare) {
+        return;
+    }
+    timer.lastControlA = controlA;
+    timer.lastControlB = controlB;
+    timer.lastCompare = compare;
+
+    unsigned long long scale = prescaler(controlB, timer2);
+    bool ctc = timer2 ? (controlA & _BV(WGM21)) != 0
+                      : ((controlB & _BV(WGM12)) != 0 && (controlB & _BV(WGM13)) == 0);
+    unsigned long long top = ctc ? (unsigned long long)compare + 1 : (timer2 ? 256 : 65536);
+
+    timer.period = scale * top;
+    timer.nextEvent = timer.period ? sim.cycles + timer.period : NEVER;
+}
+
+unsigned long long nextEventCycle() {
+    unsigned long long next = NEVER;
+
+    if (sim.scriptIndex < sim.script.size()) next = std::min(next, sim.script[sim.scriptIndex].cycle);
+    if (TIMSK0 & _BV(OCIE0A)) next = std::min(next, sim.nextTimer0);
+    if (TIMSK1 & (_BV(OCIE1A) | _BV(TOIE1))) next = std::min(next, sim.timer1.nextEvent);
+    if (TIMSK2 & (_BV(OCIE2A) | _BV(TOIE2))) next = std::min(next, sim.timer2.nextEvent);
+    next = std::min(next, sim.adcDone);
+    next = std::min(next, sim.toneStop);
+    return next;
+}
+
+void applyScriptEvent(const ScriptEvent& event) {
+    switch (event.kind) {
+        case SCRIPT_DIGITAL:
+            sim.driveLevel[event.pin] = (int)event.value;
+            break;
+        case SCRIPT_ANALOG:
+            sim.analogValue[(event.pin >= A0) ? event.pin - A0 : event.pin & 7] = (int)event.value;
+            break;
+        case SCRIPT_PULSE:
+            sim.pulseWidth[event.pin] = (unsigned long)event.value;
+            break;
+        case SCRIPT_SERIAL:
+            for (size_t i = 0; i < event.text.size(); i++) {
+                sim.serialInput.push_back((uint8_t)event.text[i]);
+            }
+            break;
+    }
+}
+
+void processDueEvents() {
+    while (sim.scriptIndex < sim.script.size() && sim.script[sim.scriptIndex].cycle <= sim.cycles) {
+        applyScriptEvent(sim.script[sim.scriptIndex++]);
+    }
+
+    // Timer0 compare A fires once per overflow period
+    if (sim.cycles >= sim.nextTimer0) {
+        if (TIMSK0 & _BV(OCIE0A)) sim.pending[VECTOR_TIMER0_COMPA] = true;
+        sim.nextTimer0 = (sim.cycles / TIMER0_PERIOD + 1) * TIMER0_PERIOD;
+    }
+
+    rescheduleTimer(sim.timer1, TCCR1A, TCCR1B, OCR1A, false);
+    if (sim.cycles >= sim.timer1.nextEvent) {
+        if (TIMSK1 & _BV(OCIE1A)) sim.pending[VECTOR_TIMER1_COMPA] = true;
+        if (TIMSK1 & _BV(TOIE1)) sim.pending[VECTOR_TIMER1_OVF] = true;
+        while (sim.timer1.nextEvent <= sim.cycles) sim.timer1.nextEvent += sim.timer1.period;
+    }
+
+    rescheduleTimer(sim.timer2, TCCR2A, TCCR2B, OCR2A, true);
+    if (sim.cycles >= sim.timer2.nextEvent) {
+        if (TIMSK2 & _BV(OCIE2A)) sim.pending[VECTOR_TIMER2_COMPA] = true;
+        if (TIMSK2 & _BV(TOIE2)) sim.pending[VECTOR_TIMER2_OVF] = true;
+        while (sim.timer2.nextEvent <= sim.cycles) sim.timer2.nextEvent += sim.timer2.period;
+    }
+
+    // ADC: a started conversion finishes ADC_CONVERSION cycles later
+    if ((ADCSRA & _BV(ADSC)) && sim.adcDone == NEVER) {
+        sim.adcDone = sim.cycles + ADC_CONVERSION;
+    }
+    if (sim.cycles >= sim.adcDone) {
+        sim.adcDone = NEVER;
+        ADC = (uint16_t)sim.analogValue[ADMUX & 0x07];
+        ADCSRA = (ADCSRA & ~_BV(ADSC)) | _BV(ADIF);
+        if (ADCSRA & _BV(ADIE)) sim.pending[VECTOR_ADC] = true;
+    }
+
+    if (sim.cycles >= sim.toneStop) {
+        sim.toneStop = NEVER;
+        sim.toneFrequency = 0;
+        record(hostsim::OUTPUT_TONE, sim.tonePin, 0);
+    }
+}
+
+void startSonarEcho();
+
+// Writing 1s to PINx toggles PORTx on the real chip
+void applyPinToggles(volatile uint8_t& pinRegister, uint8_t& lastPin, volatile uint8_t& port) {
+    if (pinRegister != lastPin) {
+        port ^= pinRegister;
+    }
+}
+
+void syncPins() {
+    applyPinToggles(PINB, sim.lastPINB, PORTB);
+    applyPinToggles(PINC, sim.lastPINC, PORTC);
+    applyPinToggles(PIND, sim.lastPIND, PORTD);
+
+    uint8_t pinB = 0, pinC = 0, pinD = 0;
+
+    for (uint8_t pin = 0; pin < NUM_DIGITAL_PINS; pin++) {
+        uint8_t mask = pinMask(pin);
+        bool isOutput = (ddrRegister(pin) & mask) != 0;
+        bool portBit = (portRegister(pin) & mask) != 0;
+
+        uint8_t level;
+        if (isOutput) {
+            level = portBit;
+        } else if (sim.driveLevel[pin] >= 0) {
+            level = (uint8_t)sim.driveLevel[pin];
+        } else {
+            level = portBit; // Pull-up, or floating low
+        }
+
+        if (level) {
+            if (pin < 8) pinD |= mask; else if (pin < 14) pinB |= mask; else pinC |= mask;
+        }
+
+        if (level == sim.pinLevel[pin]) continue;
+        sim.pinLevel[pin] = level;
+
+        if (isOutput) {
+            record(hostsim::OUTPUT_DIGITAL, pin, level);
+        }
+
+        // Ultrasonic sensor: the falling edge of the trigger pulse starts a ping
+        if (isOutput && !level && sim.sonarAttached && pin == sim.sonarTrigger) {
+            startSonarEcho();
+        }
+
+        // External interrupts on D2/D3
+        int interrupt = digitalPinToInterrupt(pin);
+        if (interrupt >= 0 && sim.external[interrupt].handler != nullptr) {
+            int mode = sim.external[interrupt].mode;
+            if (mode == CHANGE || (mode == RISING && level) || (mode != RISING && !level)) {
+                sim.pending[VECTOR_INT0 + interrupt] = true;
+            }
+        }
+
+        // Pin change interrupts
+        uint8_t group = digitalPinToPCICRbit(pin);
+        volatile uint8_t& pcmsk = (group == 0) ? PCMSK0 : ((group == 1) ? PCMSK1 : PCMSK2);
+        if ((PCICR & _BV(group)) && (pcmsk & _BV(digitalPinToPCMSKbit(pin)))) {
+            sim.pending[VECTOR_PCINT0 + group] = true;
+        }
+    }
+
+    PINB = sim.lastPINB = pinB;
+    PINC = sim.lastPINC = pinC;
+    PIND = sim.lastPIND = pinD;
+}
+
+void callVector(void (*vector)(void)) {
+    if (vector == nullptr) return;
+
+    SREG &= ~0x80;
+    sim.cycles += INTERRUPT_OVERHEAD;
+    vector();
+    SREG |= 0x80; // reti
+}
+
+void externalVector0() { if (sim.external[0].handler) sim.external[0].handler(); }
+void externalVector1() { if (sim.external[1].handler) sim.external[1].handler(); }
+
+void serviceInterrupts() {
+    static void (* const vectors[VECTOR_COUNT])(void) = {
+        externalVector0, externalVector1,
+        PCINT0_vect, PCINT1_vect, PCINT2_vect,
+        TIMER2_COMPA_vect, TIMER2_OVF_vect,
+        TIMER1_COMPA_vect, TIMER1_OVF_vect,
+        TIMER0_COMPA_vect,
+        ADC_vect
+    };
+
+    bool serviced = true;
+    while (serviced && (SREG & 0x80)) {
+        serviced = false;
+        for (int i = 0; i < VECTOR_COUNT; i++) {
+            if (!sim.pending[i]) continue;
+
+            sim.pending[i] = false;
+            if (i == VECTOR_ADC) ADCSRA &= ~_BV(ADIF);
+            callVector(vectors[i]);
+            serviced = true;
+            break; // Re-check from the highest priority
+        }
+    }
+}
+
+void advanceCycles(unsigned long long delta) {
+    unsigned long long target = sim.cycles + delta;
+
+    // Inside an ISR (or a nested core call) time just accumulates
+    if (sim.advancing) {
+        sim.cycles = target;
+        return;
+    }
+    sim.advancing = true;
+
+    while (true) {
+        processDueEvents();
+        syncPins();
+        serviceInterrupts();
+        syncPins();
+
+        if (sim.cycles >= target) break;
+
+        unsigned long long next = std::min(target, nextEventCycle());
+        if (next > sim.cycles) sim.cycles = next;
+    }
+
+    sim.advancing = false;
+}
+
+void addScriptEvent(const ScriptEvent& event) {
+    std::vector<ScriptEvent>::iterator position = std::upper_bound(
+        sim.script.begin() + sim.scriptIndex, sim.script.end(), event,
+        [](const ScriptEvent& a, const ScriptEvent& b) { return a.cycle < b.cycle; });
+    sim.script.insert(position, event);
+}
+
+// HC-SR04: the echo pin rises after the burst and stays high for the round
+// trip (the current pulse width), or for SONAR_NO_ECHO when nothing answers
+void startSonarEcho() {
+    unsigned long width = sim.pulseWidth[sim.sonarEcho];
+    unsigned long long rise = sim.cycles + SONAR_BURST * CYCLES_PER_MICRO;
+    unsigned long long fall = rise + (width ? width : SONAR_NO_ECHO) * CYCLES_PER_MICRO;
+
+    ScriptEvent high = {rise, SCRIPT_DIGITAL, sim.sonarEcho, 1, ""};
+    ScriptEvent low = {fall, SCRIPT_DIGITAL, sim.sonarEcho, 0, ""};
+    addScriptEvent(high);
+    addScriptEvent(low);
+}
+
+uint8_t parsePin(const std::string& name) {
+    if (name.size() == 2 && (name[0] == 'A' || name[0] == 'a')) {
+        return (uint8_t)(A0 + (name[1] - '0'));
+    }
+    return (uint8_t)atoi(name.c_str());
+}
+
+} // namespace
+
+// Core API
+volatile uint8_t* portOutputRegister(uint8_t port) {
+    return (port == PB) ? &PORTB : ((port == PC) ? &PORTC : ((port == PD) ? &PORTD : nullptr));
+}
+
+volatile uint8_t* portInputRegister(uint8_t port) {
+    return (port == PB) ? &PINB : ((port == PC) ? &PINC : ((port == PD) ? &PIND : nullptr));
+}
+
+volatile uint8_t* portModeRegister(uint8_t port) {
+    return (port == PB) ? &DDRB : ((port == PC) ? &DDRC : ((port == PD) ? &DDRD : nullptr));
+}
+
+void sei() {
+    SREG |= 0x80;
+}
+
+void cli() {
+    SREG &= ~0x80;
+}
+
+unsigned long millis() {
+    hostsim::detail::charge(sim.costs.millisCall);
+    return (unsigned long)(sim.cycles / (CYCLES_PER_MICRO * 1000));
+}
+
+unsigned long micros() {
+    hostsim::detail::charge(sim.costs.microsCall);
+    return (unsigned long)(sim.cycles / CYCLES_PER_MICRO);
+}
+
+void delay(unsigned long ms) {
+    advanceCycles((unsigned long long)ms * 1000 * CYCLES_PER_MICRO);
+}
+
+void delayMicroseconds(unsigned int us) {
+    advanceCycles((unsigned long long)us * CYCLES_PER_MICRO);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+
+    uint8_t mask = pinMask(pin);
+    if (mode == OUTPUT) {
+        ddrRegister(pin) |= mask;
+    } else {
+        ddrRegister(pin) &= ~mask;
+        if (mode == INPUT_PULLUP) portRegister(pin) |= mask;
+        else portRegister(pin) &= ~mask;
+    }
+    hostsim::detail::charge(sim.costs.digitalWriteCall);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+
+    sim.pwmDuty[pin] = -1;
+    if (value == LOW) portRegister(pin) &= ~pinMask(pin);
+    else portRegister(pin) |= pinMask(pin);
+    hostsim::detail::charge(sim.costs.digitalWriteCall);
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= NUM_DIGITAL_PINS) return LOW;
+
+    hostsim::detail::charge(sim.costs.digitalReadCall);
+    return sim.pinLevel[pin] ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    uint8_t channel = (pin >= A0) ? pin - A0 : pin;
+    hostsim::detail::charge(sim.costs.analogReadCall);
+    return sim.analogValue[channel & 0x07];
+}
+
+void analogWrite(uint8_t pin, int value) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+
+    ddrRegister(pin) |= pinMask(pin);
+
+    if (value <= 0 || value >= 255 || digitalPinToTimer(pin) == NOT_ON_TIMER) {
+        digitalWrite(pin, value < 128 ? LOW : HIGH);
+        return;
+    }
+
+    if (sim.pwmDuty[pin] != value) {
+        sim.pwmDuty[pin] = value;
+        record(hostsim::OUTPUT_ANALOG, pin, (unsigned long)value);
+    }
+    hostsim::detail::charge(sim.costs.analogWriteCall);
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) {
+    (void)state;
+    unsigned long width = (pin < NUM_DIGITAL_PINS) ? sim.pulseWidth[pin] : 0;
+
+    if (width == 0 || width > timeout) {
+        advanceCycles((unsigned long long)timeout * CYCLES_PER_MICRO);
+        return 0;
+    }
+    advanceCycles((unsigned long long)width * CYCLES_PER_MICRO);
+    return width;
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+    if (sim.toneFrequency != frequency || sim.tonePin != pin) {
+        sim.toneFrequency = frequency;
+        sim.tonePin = pin;
+        record(hostsim::OUTPUT_TONE, pin, frequency);
+    }
+    sim.toneStop = duration ? sim.cycles + (unsigned long long)duration * 1000 * CYCLES_PER_MICRO
+                            : NEVER;
+    hostsim::detail::charge(sim.costs.digitalWriteCall);
+}
+
+void noTone(uint8_t pin) {
+    if (sim.toneFrequency != 0 && sim.tonePin == pin) {
+        sim.toneFrequency = 0;
+        sim.toneStop = NEVER;
+        record(hostsim::OUTPUT_TONE, pin, 0);
+    }
+    hostsim::detail::charge(sim.costs.digitalWriteCall);
+}
+
+void attachInterrupt(uint8_t interruptNumber, void (*handler)(void), int mode) {
+    if (interruptNumber > 1) return;
+    sim.external[interruptNumber].handler = handler;
+    sim.external[interruptNumber].mode = mode;
+    EIMSK |= _BV(interruptNumber);
+}
+
+void detachInterrupt(uint8_t interruptNumber) {
+    if (interruptNumber > 1) return;
+    sim.external[interruptNumber].handler = nullptr;
+    EIMSK &= ~_BV(interruptNumber);
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh) {
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+// avr-libc random(): Park-Miller minimal standard generator
+static long nextRandom() {
+    int32_t x = (int32_t)sim.randomState;
+    if (x == 0) x = 123459876L;
+    int32_t hi = x / 127773L;
+    int32_t lo = x % 127773L;
+    x = 16807L * lo - 2836L * hi;
+    if (x < 0) x += 0x7FFFFFFFL;
+    sim.randomState = (uint32_t)x;
+    return x;
+}
+
+long random(long howBig) {
+    if (howBig == 0) return 0;
+    return nextRandom() % howBig;
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return random(howBig - howSmall) + howSmall;
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) sim.randomState = (uint32_t)seed;
+}
+
+// Sleep
+void set_sleep_mode(unsigned char mode) {
+    (void)mode;
+}
+
+void sleep_enable() {
+    sim.sleepEnabled = true;
+}
+
+void sleep_disable() {
+    sim.sleepEnabled = false;
+}
+
+void sleep_cpu() {
+    if (!sim.sleepEnabled) return;
+
+    // Fast-forward to whatever would wake the CPU next
+    unsigned long long next = nextEventCycle();
+    if (next == NEVER || next <= sim.cycles) next = sim.cycles + 1000 * CYCLES_PER_MICRO;
+
+    unsigned long long start = sim.cycles;
+    advanceCycles(next - sim.cycles);
+    sim.sleepCycles += sim.cycles - start;
+}
+
+void sleep_mode() {
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+}
+
+// Peripheral Glue
+namespace hostsim {
+namespace detail {
+
+void charge(unsigned int micros) {
+    advanceCycles((unsigned long long)micros * CYCLES_PER_MICRO);
+}
+
+void serialBegin(unsigned long baud) {
+    sim.serialByteCycles = baud ? 10 * CYCLES_PER_MICRO * 1000000ULL / baud : 0;
+    sim.serialIdleAt = sim.cycles;
+}
+
+// Bytes still waiting for the wire, the one being shifted out included
+unsigned long long serialQueued() {
+    if (sim.serialByteCycles == 0 || sim.serialIdleAt <= sim.cycles) return 0;
+    return (sim.serialIdleAt - sim.cycles + sim.serialByteCycles - 1) / sim.serialByteCycles;
+}
+
+int serialAvailableForWrite() {
+    unsigned long long queued = serialQueued();
+    unsigned long long inRing = (queued > 0) ? queued - 1 : 0;
+    return (int)(SERIAL_TX_BUFFER - std::min(inRing, (unsigned long long)SERIAL_TX_BUFFER));
+}
+
+void serialTransmit(uint8_t c) {
+    // A full ring makes write() spin until the UART takes a byte, like the core
+    if (sim.serialByteCycles != 0) {
+        if (serialQueued() > SERIAL_TX_BUFFER) {
+            advanceCycles(sim.serialIdleAt - SERIAL_TX_BUFFER * sim.serialByteCycles - sim.cycles);
+        }
+        sim.serialIdleAt = std::max(sim.serialIdleAt, sim.cycles) + sim.serialByteCycles;
+    }
+
+    sim.serialOutput.push_back((char)c);
+    if (sim.echoSerial) fputc(c, stdout);
+    charge(sim.costs.serialByte);
+}
+
+void serialFlush() {
+    if (sim.serialIdleAt > sim.cycles) advanceCycles(sim.serialIdleAt - sim.cycles);
+}
+
+int serialAvailable() {
+    return (int)sim.serialInput.size();
+}
+
+int serialPeek() {
+    return sim.serialInput.empty() ? -1 : sim.serialInput.front();
+}
+
+int serialRead() {
+    if (sim.serialInput.empty()) return -1;
+    int c = sim.serialInput.front();
+    sim.serialInput.pop_front();
+    return c;
+}
+
+void spiTransfer(uint8_t data) {
+    sim.spiBytes.push_back(data);
+    charge(sim.costs.spiByte);
+}
+
+uint8_t* eepromData() {
+    return sim.eeprom;
+}
+
+void eepromWritten(int address) {
+    (void)address;
+    sim.eepromWrites++;
+
+    if (!sim.eepromPath.empty()) {
+        std::ofstream file(sim.eepromPath.c_str(), std::ios::binary | std::ios::trunc);
+        file.write((const char*)sim.eeprom, EEPROM_SIZE);
+    }
+    charge(sim.costs.eepromWrite);
+}
+
+void setActiveLcd(const LiquidCrystal* lcd) {
+    sim.lcd = lcd;
+}
+
+} // namespace detail
+
+// Setup
+void reset() {
+    Simulator fresh = Simulator();
+    sim = fresh;
+
+    sim.scriptIndex = 0;
+    sim.echoSerial = true;
+    sim.adcDone = NEVER;
+    sim.toneStop = NEVER;
+    sim.nextTimer0 = TIMER0_PERIOD;
+    sim.timer1.nextEvent = NEVER;
+    sim.timer2.nextEvent = NEVER;
+    sim.randomState = 1;
+
+    for (int pin = 0; pin < NUM_DIGITAL_PINS; pin++) {
+        sim.driveLevel[pin] = -1;
+        sim.pwmDuty[pin] = -1;
+    }
+    memset(sim.eeprom, 0xFF, sizeof(sim.eeprom));
+
+    SREG = 0x80;
+    PORTB = DDRB = PINB = PORTC = DDRC = PINC = PORTD = DDRD = PIND = 0;
+    TCCR0A = TCCR0B = TCNT0 = OCR0A = OCR0B = TIMSK0 = TIFR0 = 0;
+    TCCR1A = TCCR1B = TCCR1C = TIMSK1 = TIFR1 = 0;
+    TCNT1 = OCR1A = OCR1B = ICR1 = 0;
+    TCCR2A = TCCR2B = TCNT2 = OCR2A = OCR2B = TIMSK2 = TIFR2 = 0;
+    ADMUX = ADCSRA = ADCSRB = 0;
+    ADC = 0;
+    EICRA = EIMSK = EIFR = PCICR = PCIFR = PCMSK0 = PCMSK1 = PCMSK2 = 0;
+    SPCR = SPSR = SPDR = 0;
+}
+
+CallCosts& costs() {
+    return sim.costs;
+}
+
+void setEchoSerial(bool echo) {
+    sim.echoSerial = echo;
+}
+
+void setTrace(bool trace) {
+    sim.trace = trace;
+}
+
+bool setEEPROMFile(const char* path) {
+    sim.eepromPath = path;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false; // Starts erased, created on the first write
+
+    file.read((char*)sim.eeprom, detail::EEPROM_SIZE);
+    return true;
+}
+
+// Time
+unsigned long long now() {
+    return sim.cycles / CYCLES_PER_MICRO;
+}
+
+void advance(unsigned long long micros) {
+    advanceCycles(micros * CYCLES_PER_MICRO);
+}
+
+void advanceTo(unsigned long long timeMicros) {
+    unsigned long long target = timeMicros * CYCLES_PER_MICRO;
+    if (target > sim.cycles) advanceCycles(target - sim.cycles);
+}
+
+// Scripted Inputs
+void setDigitalInput(uint8_t pin, int level) {
+    scheduleDigitalInput(now(), pin, level);
+    advanceCycles(0);
+}
+
+void setAnalogInput(uint8_t pin, int value) {
+    scheduleAnalogInput(now(), pin, value);
+    advanceCycles(0);
+}
+
+void setPulseWidth(uint8_t pin, unsigned long widthMicros) {
+    schedulePulseWidth(now(), pin, widthMicros);
+    advanceCycles(0);
+}
+
+void sendSerial(const std::string& text) {
+    scheduleSerial(now(), text);
+    advanceCycles(0);
+}
+
+void attachUltrasonic(uint8_t triggerPin, uint8_t echoPin) {
+    if (triggerPin >= NUM_DIGITAL_PINS || echoPin >= NUM_DIGITAL_PINS) return;
+    sim.sonarAttached = true;
+    sim.sonarTrigger = triggerPin;
+    sim.sonarEcho = echoPin;
+    sim.driveLevel[echoPin] = 0;
+}
+
+void scheduleDigitalInput(unsigned long long timeMicros, uint8_t pin, int level) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    ScriptEvent event = {timeMicros * CYCLES_PER_MICRO, SCRIPT_DIGITAL, pin, level, ""};
+    addScriptEvent(event);
+}
+
+void scheduleAnalogInput(unsigned long long timeMicros, uint8_t pin, int value) {
+    ScriptEvent event = {timeMicros * CYCLES_PER_MICRO, SCRIPT_ANALOG, pin, value, ""};
+    addScriptEvent(event);
+}
+
+void schedulePulseWidth(unsigned long long timeMicros, uint8_t pin, unsigned long widthMicros) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    ScriptEvent event = {timeMicros * CYCLES_PER_MICRO, SCRIPT_PULSE, pin, (long)widthMicros, ""};
+    addScriptEvent(event);
+}
+
+void scheduleSerial(unsigned long long timeMicros, const std::string& text) {
+    ScriptEvent event = {timeMicros * CYCLES_PER_MICRO, SCRIPT_SERIAL, 0, 0, text};
+    addScriptEvent(event);
+}
+
+// Script format, one event per line ('#' starts a comment):
+//   <ms> pin <pin> <0|1|z>      drive a digital input (z = release)
+//   <ms> analog <pin> <0-1023>  set an analog input
+//   <ms> pulse <pin> <us>       echo width returned by pulseIn() (or sent by a --sonar
+//                               sensor after each trigger), 0 = timeout
+//   <ms> serial <text>          send a line (newline appended)
+bool loadScript(const char* path) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream fields(line);
+        double timeMs;
+        std::string command;
+        if (!(fields >> timeMs >> command)) continue;
+
+        unsigned long long timeMicros = (unsigned long long)(timeMs * 1000.0);
+
+        if (command == "serial") {
+            std::string text;
+            std::getline(fields, text);
+            size_t start = text.find_first_not_of(' ');
+            text = (start == std::string::npos) ? "" : text.substr(start);
+            scheduleSerial(timeMicros, text + "\n");
+            continue;
+        }
+
+        std::string pinName, value;
+        if (!(fields >> pinName >> value)) continue;
+        uint8_t pin = parsePin(pinName);
+
+        if (command == "pin") {
+            scheduleDigitalInput(timeMicros, pin, (value == "z") ? -1 : atoi(value.c_str()));
+        } else if (command == "analog") {
+            scheduleAnalogInput(timeMicros, pin, atoi(value.c_str()));
+        } else if (command == "pulse") {
+            schedulePulseWidth(timeMicros, pin, strtoul(value.c_str(), nullptr, 10));
+        } else {
+            fprintf(stderr, "%s: unknown command '%s'\n", path, command.c_str());
+        }
+    }
+    return true;
+}
+
+// Recorded Outputs
+int getPinLevel(uint8_t pin) {
+    return (pin < NUM_DIGITAL_PINS) ? sim.pinLevel[pin] : LOW;
+}
+
+const std::vector<OutputEvent>& outputEvents() {
+    return sim.outputs;
+}
+
+void clearOutputEvents() {
+    sim.outputs.clear();
+}
+
+const std::string& serialOutput() {
+    return sim.serialOutput;
+}
+
+void clearSerialOutput() {
+    sim.serialOutput.clear();
+}
+
+const std::vector<uint8_t>& spiCapture() {
+    return sim.spiBytes;
+}
+
+void clearSpiCapture() {
+    sim.spiBytes.clear();
+}
+
+std::string lcdRow(uint8_t row) {
+    if (sim.lcd == nullptr) return std::string();
+    return sim.lcd->hostRow(row);
+}
+
+uint8_t eepromRead(int address) {
+    return (address >= 0 && address < detail::EEPROM_SIZE) ? sim.eeprom[address] : 0xFF;
+}
+
+unsigned long eepromWriteCount() {
+    return sim.eepromWrites;
+}
+
+// Sketch Driving
+void runSetup() {
+    ::setup();
+}
+
+void runLoop() {
+    ::loop();
+    sim.loops++;
+    detail::charge(sim.costs.loopOverhead);
+}
+
+unsigned long long loopCount() {
+    return sim.loops;
+}
+
+unsigned long long sleepMicros() {
+    return sim.sleepCycles / CYCLES_PER_MICRO;
+}
+
+} // namespace hostsim
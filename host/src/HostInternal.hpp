@@ -0,0 +1,40 @@
+// HostInternal.hpp
+// Glue between the simulated core and the peripheral stand-ins.
+
+#ifndef HOST_INTERNAL_HPP
+#define HOST_INTERNAL_HPP
+
+#include <stdint.h>
+
+class LiquidCrystal;
+
+namespace hostsim {
+namespace detail {
+
+// Charge virtual time for a core call (runs due events and interrupts)
+void charge(unsigned int micros);
+
+// Serial (output drains at the begin() baud rate)
+void serialBegin(unsigned long baud);
+int serialAvailableForWrite();
+void serialTransmit(uint8_t c);
+void serialFlush();
+int serialAvailable();
+int serialPeek();
+int serialRead();
+
+// SPI
+void spiTransfer(uint8_t data);
+
+// EEPROM
+const int EEPROM_SIZE = 1024;
+uint8_t* eepromData();
+void eepromWritten(int address);
+
+// LCD (the most recently started display is the one HostSim reports)
+void setActiveLcd(const LiquidCrystal* lcd);
+
+} // namespace detail
+} // namespace hostsim
+
+#endif // HOST_INTERNAL_HPP
@@ -0,0 +1,93 @@
+// LiquidCrystal.cpp (host)
+#include <LiquidCrystal.h>
+
+#include <string.h>
+
+#include "HostInternal.hpp"
+
+namespace {
+
+// The controller takes ~40us per character or cursor command over the 4-bit bus
+const unsigned int COMMAND_MICROS = 40;
+const unsigned int CLEAR_MICROS = 2000;
+
+} // namespace
+
+LiquidCrystal::LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t)
+    : columns(16), rows(2), cursorColumn(0), cursorRow(0) {
+    memset(buffer, ' ', sizeof(buffer));
+    memset(glyphs, 0, sizeof(glyphs));
+}
+
+LiquidCrystal::LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t)
+    : columns(16), rows(2), cursorColumn(0), cursorRow(0) {
+    memset(buffer, ' ', sizeof(buffer));
+    memset(glyphs, 0, sizeof(glyphs));
+}
+
+LiquidCrystal::LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t,
+                             uint8_t, uint8_t, uint8_t, uint8_t)
+    : columns(16), rows(2), cursorColumn(0), cursorRow(0) {
+    memset(buffer, ' ', sizeof(buffer));
+    memset(glyphs, 0, sizeof(glyphs));
+}
+
+void LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t) {
+    columns = (cols > MAX_COLUMNS) ? MAX_COLUMNS : cols;
+    rows = (lines > MAX_ROWS) ? MAX_ROWS : lines;
+    if (rows == 0) rows = 1;
+
+    hostsim::detail::setActiveLcd(this);
+    clear();
+}
+
+void LiquidCrystal::clear() {
+    memset(buffer, ' ', sizeof(buffer));
+    cursorColumn = 0;
+    cursorRow = 0;
+    hostsim::detail::charge(CLEAR_MICROS);
+}
+
+void LiquidCrystal::home() {
+    cursorColumn = 0;
+    cursorRow = 0;
+    hostsim::detail::charge(CLEAR_MICROS);
+}
+
+void LiquidCrystal::setCursor(uint8_t col, uint8_t row) {
+    cursorColumn = col;
+    cursorRow = (row >= rows) ? rows - 1 : row;
+    hostsim::detail::charge(COMMAND_MICROS);
+}
+
+void LiquidCrystal::createChar(uint8_t location, uint8_t charmap[]) {
+    location &= 0x07;
+    memcpy(glyphs[location], charmap, 8);
+    hostsim::detail::charge(COMMAND_MICROS * 9);
+}
+
+size_t LiquidCrystal::write(uint8_t c) {
+    // Characters past the visible columns are dropped, like on a 16x2 module
+    if (cursorColumn < columns) {
+        buffer[cursorRow][cursorColumn] = (char)c;
+    }
+    if (cursorColumn < MAX_COLUMNS) cursorColumn++;
+
+    hostsim::detail::charge(COMMAND_MICROS);
+    return 1;
+}
+
+std::string LiquidCrystal::hostRow(uint8_t row) const {
+    static const char glyphNames[] = "@#$%&*+=";
+
+    std::string text;
+    if (row >= rows) return text;
+
+    for (uint8_t col = 0; col < columns; col++) {
+        uint8_t c = (uint8_t)buffer[row][col];
+        if (c < 8) text += glyphNames[c];
+        else if (c < 0x20 || c >= 0x7F) text += '?';
+        else text += (char)c;
+    }
+    return text;
+}
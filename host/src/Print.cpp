@@ -0,0 +1,154 @@
+// Print.cpp (host)
+#include <Print.h>
+
+#include <math.h>
+#include <string.h>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::write(const char* text) {
+    if (text == nullptr) return 0;
+    return write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::printNumber(unsigned long value, uint8_t base) {
+    char buffer[8 * sizeof(long) + 1];
+    char* digit = &buffer[sizeof(buffer) - 1];
+    *digit = '\0';
+
+    if (base < 2) base = 10;
+
+    do {
+        char remainder = (char)(value % base);
+        value /= base;
+        *--digit = (remainder < 10) ? remainder + '0' : remainder + 'A' - 10;
+    } while (value);
+
+    return write(digit);
+}
+
+// Print
+size_t Print::print(const __FlashStringHelper* text) {
+    return write(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(const String& text) {
+    return write((const uint8_t*)text.c_str(), text.length());
+}
+
+size_t Print::print(const char* text) {
+    return write(text);
+}
+
+size_t Print::print(char c) {
+    return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base) {
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+    // 32-bit like the AVR, so wrap-around prints the same on both
+    int32_t narrow = (int32_t)value;
+
+    if (base == 10 && narrow < 0) {
+        size_t written = print('-');
+        return written + printNumber((unsigned long)(-(int64_t)narrow), 10);
+    }
+    if (base == 0) return write((uint8_t)narrow);
+    return printNumber((uint32_t)narrow, (uint8_t)base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    if (base == 0) return write((uint8_t)value);
+    return printNumber((uint32_t)value, (uint8_t)base);
+}
+
+size_t Print::print(double value, int digits) {
+    if (isnan(value)) return print("nan");
+    if (isinf(value)) return print("inf");
+
+    size_t written = 0;
+    if (value < 0.0) {
+        written += print('-');
+        value = -value;
+    }
+
+    // Round the same way the core does
+    double rounding = 0.5;
+    for (int i = 0; i < digits; i++) rounding /= 10.0;
+    value += rounding;
+
+    unsigned long integer = (unsigned long)value;
+    double remainder = value - (double)integer;
+    written += print(integer);
+
+    if (digits > 0) written += print('.');
+    while (digits-- > 0) {
+        remainder *= 10.0;
+        unsigned int digit = (unsigned int)remainder;
+        written += print(digit);
+        remainder -= digit;
+    }
+    return written;
+}
+
+// Println
+size_t Print::println() {
+    return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper* text) {
+    return print(text) + println();
+}
+
+size_t Print::println(const String& text) {
+    return print(text) + println();
+}
+
+size_t Print::println(const char* text) {
+    return print(text) + println();
+}
+
+size_t Print::println(char c) {
+    return print(c) + println();
+}
+
+size_t Print::println(unsigned char value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(int value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits) {
+    return print(value, digits) + println();
+}
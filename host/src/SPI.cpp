@@ -0,0 +1,52 @@
+// SPI.cpp (host)
+#include <Arduino.h>
+#include <SPI.h>
+
+#include "HostInternal.hpp"
+
+SPIClass SPI;
+
+void SPIClass::begin() {
+    // Same pin setup as the core: SS high, SCK/MOSI outputs
+    digitalWrite(SS, HIGH);
+    pinMode(SS, OUTPUT);
+    pinMode(SCK, OUTPUT);
+    pinMode(MOSI, OUTPUT);
+    SPCR |= _BV(MSTR) | _BV(SPE);
+}
+
+void SPIClass::end() {
+    SPCR &= ~_BV(SPE);
+}
+
+void SPIClass::beginTransaction(const SPISettings& settings) {
+    (void)settings;
+}
+
+void SPIClass::endTransaction() {}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+    SPDR = data;
+    hostsim::detail::spiTransfer(data);
+    SPSR |= _BV(SPIF);
+    return 0;
+}
+
+void SPIClass::transfer(void* buffer, size_t count) {
+    uint8_t* bytes = (uint8_t*)buffer;
+    for (size_t i = 0; i < count; i++) {
+        bytes[i] = transfer(bytes[i]);
+    }
+}
+
+void SPIClass::setBitOrder(uint8_t order) {
+    (void)order;
+}
+
+void SPIClass::setDataMode(uint8_t mode) {
+    SPCR = (SPCR & ~0x0C) | (mode & 0x0C);
+}
+
+void SPIClass::setClockDivider(uint8_t divider) {
+    SPCR = (SPCR & ~0x03) | (divider & 0x03);
+}
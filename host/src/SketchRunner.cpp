@@ -0,0 +1,133 @@
+// SketchRunner.cpp
+// Command-line driver: runs a sketch for a stretch of virtual time.
+//
+//   host_project5 --ms 5000 --script inputs.txt --eeprom eeprom.bin --lcd
+//
+// Options:
+//   --ms N          virtual milliseconds to run (default 2000)
+//   --script FILE   timed inputs, format documented in HostCore.cpp
+//   --eeprom FILE   EEPROM contents, loaded at start and saved on change
+//   --input TEXT    serial line sent right after setup()
+//   --pin P=L       drive a digital input from the start (L = 0, 1 or z)
+//   --analog P=V    set an analog input from the start
+//   --pulse P=US    echo width pulseIn() measures on pin P from the start
+//   --sonar T=E     ultrasonic sensor: trigger pin T answered on echo pin E
+//                   with the --pulse width of E
+//   --quiet         don't echo Serial output
+//   --lcd           print the LCD contents at the end
+//   --trace         print every output change as it happens
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "HostSim.hpp"
+
+namespace {
+
+void printUsage(const char* program) {
+    fprintf(stderr,
+            "usage: %s [--ms N] [--script FILE] [--eeprom FILE] [--input TEXT]\n"
+            "          [--pin P=L] [--analog P=V] [--pulse P=US] [--sonar T=E]\n"
+            "          [--quiet] [--lcd] [--trace]\n",
+            program);
+}
+
+uint8_t parsePin(const std::string& name) {
+    if (name.size() == 2 && (name[0] == 'A' || name[0] == 'a')) {
+        return (uint8_t)(A0 + (name[1] - '0'));
+    }
+    return (uint8_t)atoi(name.c_str());
+}
+
+bool splitAssignment(const char* argument, uint8_t& pin, std::string& value) {
+    const char* equals = strchr(argument, '=');
+    if (equals == nullptr) return false;
+
+    pin = parsePin(std::string(argument, equals));
+    value = equals + 1;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned long long runMillis = 2000;
+    const char* scriptPath = nullptr;
+    const char* eepromPath = nullptr;
+    std::string serialInput;
+    bool showLcd = false;
+
+    hostsim::reset();
+
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        bool hasValue = (i + 1 < argc);
+        uint8_t pin;
+        std::string value;
+
+        if (!strcmp(option, "--ms") && hasValue) {
+            runMillis = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(option, "--script") && hasValue) {
+            scriptPath = argv[++i];
+        } else if (!strcmp(option, "--eeprom") && hasValue) {
+            eepromPath = argv[++i];
+        } else if (!strcmp(option, "--input") && hasValue) {
+            serialInput = std::string(argv[++i]) + "\n";
+        } else if (!strcmp(option, "--pin") && hasValue && splitAssignment(argv[++i], pin, value)) {
+            hostsim::setDigitalInput(pin, (value == "z") ? -1 : atoi(value.c_str()));
+        } else if (!strcmp(option, "--analog") && hasValue && splitAssignment(argv[++i], pin, value)) {
+            hostsim::setAnalogInput(pin, atoi(value.c_str()));
+        } else if (!strcmp(option, "--pulse") && hasValue && splitAssignment(argv[++i], pin, value)) {
+            hostsim::setPulseWidth(pin, strtoul(value.c_str(), nullptr, 10));
+        } else if (!strcmp(option, "--sonar") && hasValue && splitAssignment(argv[++i], pin, value)) {
+            hostsim::attachUltrasonic(pin, parsePin(value));
+        } else if (!strcmp(option, "--quiet")) {
+            hostsim::setEchoSerial(false);
+        } else if (!strcmp(option, "--lcd")) {
+            showLcd = true;
+        } else if (!strcmp(option, "--trace")) {
+            hostsim::setTrace(true);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (eepromPath != nullptr) {
+        hostsim::setEEPROMFile(eepromPath);
+    }
+    if (scriptPath != nullptr && !hostsim::loadScript(scriptPath)) {
+        fprintf(stderr, "cannot read script %s\n", scriptPath);
+        return 1;
+    }
+
+    hostsim::runSetup();
+    if (!serialInput.empty()) {
+        hostsim::sendSerial(serialInput);
+    }
+
+    unsigned long long endMicros = runMillis * 1000ULL;
+    while (hostsim::now() < endMicros) {
+        hostsim::runLoop();
+    }
+    fflush(stdout);
+
+    if (showLcd) {
+        fprintf(stderr, "+----------------+\n");
+        for (uint8_t row = 0; row < 2; row++) {
+            fprintf(stderr, "|%-16s|\n", hostsim::lcdRow(row).c_str());
+        }
+        fprintf(stderr, "+----------------+\n");
+    }
+
+    unsigned long long loops = hostsim::loopCount();
+    fprintf(stderr, "%llu ms virtual, %llu loops (%.1f us/loop), %llu ms asleep, "
+                    "%zu output events, %lu EEPROM writes\n",
+            hostsim::now() / 1000, loops,
+            loops ? (double)hostsim::now() / (double)loops : 0.0,
+            hostsim::sleepMicros() / 1000,
+            hostsim::outputEvents().size(), hostsim::eepromWriteCount());
+    return 0;
+}
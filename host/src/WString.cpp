@@ -0,0 +1,156 @@
+// WString.cpp (host)
+#include <WString.h>
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace {
+
+std::string formatNumber(unsigned long value, unsigned char base, bool negative) {
+    if (base < 2) base = 10;
+
+    std::string digits;
+    do {
+        int remainder = (int)(value % base);
+        value /= base;
+        digits.insert(digits.begin(), (char)((remainder < 10) ? remainder + '0'
+                                                              : remainder + 'a' - 10));
+    } while (value);
+
+    if (negative) digits.insert(digits.begin(), '-');
+    return digits;
+}
+
+} // namespace
+
+String::String(const char* text) : buffer(text ? text : "") {}
+
+String::String(const __FlashStringHelper* text)
+    : buffer(text ? reinterpret_cast<const char*>(text) : "") {}
+
+String::String(char c) : buffer(1, c) {}
+
+String::String(int value, unsigned char base) {
+    bool negative = (base == 10 && value < 0);
+    buffer = formatNumber(negative ? (unsigned long)(-(long)value) : (unsigned int)value,
+                          base, negative);
+}
+
+String::String(unsigned int value, unsigned char base)
+    : buffer(formatNumber(value, base, false)) {}
+
+String::String(long value, unsigned char base) {
+    int32_t narrow = (int32_t)value;
+    bool negative = (base == 10 && narrow < 0);
+    buffer = formatNumber(negative ? (unsigned long)(-(int64_t)narrow) : (uint32_t)narrow,
+                          base, negative);
+}
+
+String::String(unsigned long value, unsigned char base)
+    : buffer(formatNumber((uint32_t)value, base, false)) {}
+
+unsigned int String::length() const {
+    return (unsigned int)buffer.size();
+}
+
+const char* String::c_str() const {
+    return buffer.c_str();
+}
+
+char String::charAt(unsigned int index) const {
+    return (index < buffer.size()) ? buffer[index] : '\0';
+}
+
+char String::operator[](unsigned int index) const {
+    return charAt(index);
+}
+
+String& String::operator=(const char* text) {
+    buffer = text ? text : "";
+    return *this;
+}
+
+String& String::operator+=(const String& other) {
+    buffer += other.buffer;
+    return *this;
+}
+
+String& String::operator+=(const char* text) {
+    if (text) buffer += text;
+    return *this;
+}
+
+String& String::operator+=(char c) {
+    buffer += c;
+    return *this;
+}
+
+bool String::operator==(const String& other) const {
+    return buffer == other.buffer;
+}
+
+bool String::operator==(const char* text) const {
+    return buffer == (text ? text : "");
+}
+
+bool String::operator!=(const String& other) const {
+    return !(*this == other);
+}
+
+bool String::operator!=(const char* text) const {
+    return !(*this == text);
+}
+
+bool String::equals(const String& other) const {
+    return *this == other;
+}
+
+void String::trim() {
+    size_t start = 0;
+    while (start < buffer.size() && isspace((unsigned char)buffer[start])) start++;
+
+    size_t end = buffer.size();
+    while (end > start && isspace((unsigned char)buffer[end - 1])) end--;
+
+    buffer = buffer.substr(start, end - start);
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < buffer.size(); i++) buffer[i] = (char)toupper((unsigned char)buffer[i]);
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < buffer.size(); i++) buffer[i] = (char)tolower((unsigned char)buffer[i]);
+}
+
+long String::toInt() const {
+    return (int32_t)atol(buffer.c_str());
+}
+
+int String::indexOf(char c) const {
+    size_t position = buffer.find(c);
+    return (position == std::string::npos) ? -1 : (int)position;
+}
+
+String String::substring(unsigned int from) const {
+    return substring(from, length());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        unsigned int swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from >= buffer.size()) return String();
+    if (to > buffer.size()) to = (unsigned int)buffer.size();
+
+    return String(buffer.substr(from, to - from).c_str());
+}
+
+String operator+(const String& left, const String& right) {
+    String result(left);
+    result += right;
+    return result;
+}
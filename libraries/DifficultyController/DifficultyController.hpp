@@ -0,0 +1,122 @@
+// DifficultyController.hpp
+// Adaptive difficulty for memory games: steers one difficulty level so the
+// player wins about targetSuccess percent of rounds.
+//
+// Every round adds credit: a win adds (100 - target), scaled down when the
+// telemetry shows hesitation (slow first input, slow entry, extra character
+// cycles), and a loss subtracts target. When the credit reaches +/- stepCredit
+// the level moves one step and the credit starts over. The credit only
+// drifts when the win rate is off target, so the level settles where the
+// (confident) win rate matches it.
+//
+// Levels first shorten the time each symbol is shown, from startSymbolTime
+// down to minimumSymbolTime, then lengthen the sequence a new game starts
+// with, up to maxStartLength. The model is four bytes: level, credit and a
+// success rate kept for reporting.
+
+#ifndef DIFFICULTY_CONTROLLER_HPP
+#define DIFFICULTY_CONTROLLER_HPP
+
+#include <Arduino.h>
+
+// Measured during one round's input phase
+struct RoundTelemetry {
+    unsigned long firstInputTime; // ms from the start of input to the first input event
+    unsigned long submitTime;     // ms from the start of input to the end of the round
+    uint16_t symbols;             // Symbols entered (checked) this round
+    uint16_t extraCycles;         // Character cycles beyond the shortest path, summed
+};
+
+struct DifficultyConfig {
+    uint8_t targetSuccess;           // Percent of rounds won
+    int16_t stepCredit;              // Credit needed to move one level
+    unsigned int startSymbolTime;    // ms per symbol at level 0
+    unsigned int minimumSymbolTime;
+    unsigned int stepSymbolTime;     // Per level
+    uint8_t maxStartLength;          // Symbols a game starts with at the top level
+    unsigned int comfortableFirstInput;  // ms, slower counts as hesitation
+    unsigned int comfortableSymbolEntry; // ms per symbol entered
+    uint8_t comfortableExtraCycles;      // x4 per symbol (4 = one spare cycle each)
+};
+
+class DifficultyController {
+public:
+    explicit DifficultyController(const DifficultyConfig& difficultyConfig)
+        : config(difficultyConfig), level(0), credit(0), successRate(128) {}
+
+    // Hesitation signals in the telemetry (0-3)
+    uint8_t hesitation(const RoundTelemetry& round) const {
+        uint8_t signals = 0;
+        uint16_t symbols = round.symbols > 0 ? round.symbols : 1;
+
+        if (round.firstInputTime > config.comfortableFirstInput) signals++;
+        if (round.submitTime > (unsigned long)symbols * config.comfortableSymbolEntry) signals++;
+        if ((unsigned long)round.extraCycles * 4 > (unsigned long)symbols * config.comfortableExtraCycles) {
+            signals++;
+        }
+        return signals;
+    }
+
+    void recordRound(bool won, const RoundTelemetry& round) {
+        // Success rate x255, exponential average over ~8 rounds
+        int target = won ? 255 : 0;
+        successRate = (uint8_t)(successRate + (target - (int)successRate) / 8);
+
+        if (won) {
+            // Confident wins count fully, each hesitation signal takes a quarter off
+            credit += (int16_t)((100 - config.targetSuccess) * (4 - hesitation(round)) / 4);
+        } else {
+            credit -= config.targetSuccess;
+        }
+
+        if (credit >= config.stepCredit) {
+            if (level < getMaxLevel()) level++;
+            credit = 0;
+        } else if (credit <= -config.stepCredit) {
+            if (level > 0) level--;
+            credit = 0;
+        }
+    }
+
+    unsigned int getSymbolTime() const {
+        unsigned long reduction = (unsigned long)level * config.stepSymbolTime;
+        unsigned int range = config.startSymbolTime - config.minimumSymbolTime;
+        return config.startSymbolTime - (unsigned int)(reduction < range ? reduction : range);
+    }
+
+    uint8_t getStartLength() const {
+        uint8_t timeLevels = getTimeLevels();
+        return 1 + (level > timeLevels ? level - timeLevels : 0);
+    }
+
+    uint8_t getLevel() const {
+        return level;
+    }
+
+    uint8_t getMaxLevel() const {
+        return getTimeLevels() + config.maxStartLength - 1;
+    }
+
+    // Recent rounds won, in percent
+    uint8_t getSuccessPercent() const {
+        return (uint8_t)(((unsigned int)successRate * 100 + 127) / 255);
+    }
+
+    void setLevel(uint8_t newLevel) {
+        level = newLevel < getMaxLevel() ? newLevel : getMaxLevel();
+        credit = 0;
+    }
+
+private:
+    const DifficultyConfig config;
+
+    uint8_t level;
+    int16_t credit;
+    uint8_t successRate;
+
+    uint8_t getTimeLevels() const {
+        return (config.startSymbolTime - config.minimumSymbolTime) / config.stepSymbolTime;
+    }
+};
+
+#endif // DIFFICULTY_CONTROLLER_HPP
@@ -0,0 +1,144 @@
+// DistanceFilter.hpp
+// Motion detection for an ultrasonic range finder, one sample at a time:
+//
+//   median    of the last WINDOW samples, so a single bad echo (a dropout or
+//             a multipath reflection) never reaches the detector
+//   baseline  exponential average of the median, only updated while the scene
+//             is quiet, so slow drift is followed but an intruder is not learned
+//   energy    exponential average of the squared distance between the median
+//             and the baseline: a variance around the baseline, which rises
+//             while something moves and stays up while it stands where the
+//             scene used to be
+//
+// A sample is suspicious when the energy passes sensitivity squared, and
+// motion is reported once confirmCount samples in a row were suspicious.
+// "No echo" is treated as a far distance (outOfRange), so an empty range has
+// a baseline too and anything stepping into it shows up as a deviation.
+//
+// All integer: the baseline is kept in 1/256 cm and the energy in 1/256 cm^2.
+// The window is a ring buffer plus a sorted copy, so a sample costs one
+// removal and one insertion of WINDOW entries at most, whatever the history.
+
+#ifndef DISTANCE_FILTER_HPP
+#define DISTANCE_FILTER_HPP
+
+#include <Arduino.h>
+
+struct DistanceFilterConfig {
+    uint16_t sensitivity;    // cm the median may stray from the baseline
+    uint8_t confirmCount;    // Suspicious samples in a row before motion is reported
+    uint8_t energyShift;     // Energy moves 1/2^shift of the way to each new deviation
+    uint8_t baselineShift;   // Quiet samples move the baseline 1/2^shift of the way
+    uint16_t outOfRange;     // cm used for "no echo" (0)
+};
+
+template <uint8_t WINDOW>
+class DistanceFilter {
+public:
+    static_assert(WINDOW % 2 == 1 && WINDOW <= 15, "the window must be odd and short");
+
+    explicit DistanceFilter(const DistanceFilterConfig& filterConfig)
+        : config(filterConfig), next(0), baseline(0), energy(0), suspiciousCount(0) {
+        begin(0);
+    }
+
+    // Forget the history; the window and the baseline start at distance
+    void begin(uint16_t distance) {
+        distance = inRange(distance);
+        for (uint8_t i = 0; i < WINDOW; i++) {
+            samples[i] = distance;
+            sorted[i] = distance;
+        }
+        next = 0;
+        baseline = (int32_t)distance << 8;
+        energy = 0;
+        suspiciousCount = 0;
+    }
+
+    // Take the current median as the quiet scene (after arming, say)
+    void rebase() {
+        baseline = (int32_t)getMedian() << 8;
+        energy = 0;
+        suspiciousCount = 0;
+    }
+
+    // distance in cm, 0 = no echo; returns isMotion()
+    bool addSample(uint16_t distance) {
+        distance = inRange(distance);
+        replaceSorted(samples[next], distance);
+        samples[next] = distance;
+        next = (next + 1) % WINDOW;
+
+        // Deviation in 1/16 cm, so its square is in 1/256 cm^2. Clipped at
+        // twice the sensitivity so one wild median can't hold the energy up
+        // for long
+        int32_t deviation = (((int32_t)getMedian() << 8) - baseline) / 16;
+        int32_t clip = (int32_t)config.sensitivity * 32;
+        deviation = deviation > clip ? clip : (deviation < -clip ? -clip : deviation);
+        uint32_t square = (uint32_t)(deviation * deviation);
+        energy = energy - (energy >> config.energyShift) + (square >> config.energyShift);
+
+        uint32_t limit = (uint32_t)config.sensitivity * config.sensitivity << 8;
+        if (energy > limit) {
+            if (suspiciousCount < 0xFF) suspiciousCount++;
+        } else {
+            suspiciousCount = 0;
+            baseline += (((int32_t)getMedian() << 8) - baseline) / (1L << config.baselineShift);
+        }
+        return isMotion();
+    }
+
+    bool isMotion() const {
+        return suspiciousCount >= config.confirmCount;
+    }
+
+    void setSensitivity(uint16_t sensitivity) {
+        config.sensitivity = sensitivity;
+    }
+
+    uint16_t getMedian() const {
+        return sorted[WINDOW / 2];
+    }
+
+    // cm, rounded
+    uint16_t getBaseline() const {
+        return (uint16_t)((baseline + 128) >> 8);
+    }
+
+    // Mean square deviation from the baseline, cm^2
+    uint32_t getEnergy() const {
+        return energy >> 8;
+    }
+
+private:
+    DistanceFilterConfig config;
+
+    uint16_t samples[WINDOW];  // Arrival order, next is the oldest
+    uint16_t sorted[WINDOW];   // The same values, ascending
+    uint8_t next;
+    int32_t baseline;          // 1/256 cm
+    uint32_t energy;           // 1/256 cm^2
+    uint8_t suspiciousCount;
+
+    uint16_t inRange(uint16_t distance) const {
+        return (distance == 0 || distance > config.outOfRange) ? config.outOfRange : distance;
+    }
+
+    // Swap the oldest value for the newest and keep the copy sorted
+    void replaceSorted(uint16_t oldest, uint16_t newest) {
+        uint8_t i = 0;
+        while (sorted[i] != oldest) i++;
+
+        while (i > 0 && sorted[i - 1] > newest) {
+            sorted[i] = sorted[i - 1];
+            i--;
+        }
+        while (i < WINDOW - 1 && sorted[i + 1] < newest) {
+            sorted[i] = sorted[i + 1];
+            i++;
+        }
+        sorted[i] = newest;
+    }
+};
+
+#endif // DISTANCE_FILTER_HPP
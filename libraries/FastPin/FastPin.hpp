@@ -0,0 +1,138 @@
+// FastPin.hpp
+// Compile-time pin access for the ATmega328P (Arduino Uno / Nano).
+//
+// FastPin<N> resolves pin N to its port register and bit mask at compile
+// time, so high()/low() can compile to a single sbi/cbi instead of the pin
+// table lookups and PWM checks of digitalWrite(). How much that saves on the
+// Project 2 and 4 display paths has not been measured. Pins that were driven
+// with analogWrite() must be released with digitalWrite() first, FastPin does
+// not turn PWM off.
+//
+// FastPinGroup<N...> drives several pins at once: a bit pattern (bit i = i-th
+// pin) is turned into one image per port, which can be precomputed as a
+// constant and written with a single store per port.
+
+#ifndef FAST_PIN_HPP
+#define FAST_PIN_HPP
+
+#include <Arduino.h>
+
+// Port identifiers
+const uint8_t FAST_PORT_B = 0; // D8 - D13
+const uint8_t FAST_PORT_C = 1; // A0 - A5 (14 - 19)
+const uint8_t FAST_PORT_D = 2; // D0 - D7
+
+constexpr uint8_t fastPinPort(uint8_t pin) {
+    return pin < 8 ? FAST_PORT_D : (pin < 14 ? FAST_PORT_B : FAST_PORT_C);
+}
+
+constexpr uint8_t fastPinMask(uint8_t pin) {
+    return (uint8_t)(1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14)));
+}
+
+// Register access per port
+template <uint8_t PORT_ID> struct FastPort;
+
+template <> struct FastPort<FAST_PORT_B> {
+    static inline volatile uint8_t& out() { return PORTB; }
+    static inline volatile uint8_t& dir() { return DDRB; }
+    static inline volatile uint8_t& in() { return PINB; }
+};
+
+template <> struct FastPort<FAST_PORT_C> {
+    static inline volatile uint8_t& out() { return PORTC; }
+    static inline volatile uint8_t& dir() { return DDRC; }
+    static inline volatile uint8_t& in() { return PINC; }
+};
+
+template <> struct FastPort<FAST_PORT_D> {
+    static inline volatile uint8_t& out() { return PORTD; }
+    static inline volatile uint8_t& dir() { return DDRD; }
+    static inline volatile uint8_t& in() { return PIND; }
+};
+
+// Single Pin
+template <uint8_t PIN>
+struct FastPin {
+    static_assert(PIN < 20, "FastPin only maps the ATmega328P pins D0-D13 and A0-A5");
+
+    typedef FastPort<fastPinPort(PIN)> Port;
+    static const uint8_t mask = fastPinMask(PIN);
+
+    static inline void output() { Port::dir() |= mask; }
+    static inline void input() { Port::dir() &= ~mask; Port::out() &= ~mask; }
+    static inline void inputPullup() { Port::dir() &= ~mask; Port::out() |= mask; }
+
+    static inline void high() { Port::out() |= mask; }
+    static inline void low() { Port::out() &= ~mask; }
+    static inline void write(bool value) { if (value) high(); else low(); }
+    static inline void toggle() { Port::in() = mask; } // Writing PINx toggles the output
+    static inline bool read() { return (Port::in() & mask) != 0; }
+};
+
+// Pin Group
+struct FastPortImage {
+    uint8_t portB;
+    uint8_t portC;
+    uint8_t portD;
+};
+
+// Recursive helpers: mask and image of the group pins living on PORT_ID
+template <uint8_t PORT_ID, uint8_t INDEX, uint8_t... PINS>
+struct FastGroupPort {
+    static constexpr uint8_t mask() { return 0; }
+    static constexpr uint8_t image(uint8_t) { return 0; }
+};
+
+template <uint8_t PORT_ID, uint8_t INDEX, uint8_t PIN, uint8_t... REST>
+struct FastGroupPort<PORT_ID, INDEX, PIN, REST...> {
+    static constexpr uint8_t mask() {
+        return (fastPinPort(PIN) == PORT_ID ? fastPinMask(PIN) : 0) |
+               FastGroupPort<PORT_ID, INDEX + 1, REST...>::mask();
+    }
+
+    static constexpr uint8_t image(uint8_t bits) {
+        return ((fastPinPort(PIN) == PORT_ID && ((bits >> INDEX) & 1)) ? fastPinMask(PIN) : 0) |
+               FastGroupPort<PORT_ID, INDEX + 1, REST...>::image(bits);
+    }
+};
+
+template <uint8_t... PINS>
+struct FastPinGroup {
+    static_assert(sizeof...(PINS) <= 8, "FastPinGroup patterns are 8 bits wide");
+
+    static const uint8_t maskB = FastGroupPort<FAST_PORT_B, 0, PINS...>::mask();
+    static const uint8_t maskC = FastGroupPort<FAST_PORT_C, 0, PINS...>::mask();
+    static const uint8_t maskD = FastGroupPort<FAST_PORT_D, 0, PINS...>::mask();
+
+    // Bit pattern (bit i drives the i-th pin) to port images, usable in constant tables
+    static constexpr FastPortImage image(uint8_t bits) {
+        return FastPortImage{
+            FastGroupPort<FAST_PORT_B, 0, PINS...>::image(bits),
+            FastGroupPort<FAST_PORT_C, 0, PINS...>::image(bits),
+            FastGroupPort<FAST_PORT_D, 0, PINS...>::image(bits)
+        };
+    }
+
+    static inline void output() {
+        if (maskB) FastPort<FAST_PORT_B>::dir() |= maskB;
+        if (maskC) FastPort<FAST_PORT_C>::dir() |= maskC;
+        if (maskD) FastPort<FAST_PORT_D>::dir() |= maskD;
+    }
+
+    // One read-modify-write store per port used by the group
+    static inline void write(const FastPortImage& value) {
+        uint8_t oldSREG = SREG;
+        cli();
+        if (maskB) FastPort<FAST_PORT_B>::out() = (FastPort<FAST_PORT_B>::out() & ~maskB) | value.portB;
+        if (maskC) FastPort<FAST_PORT_C>::out() = (FastPort<FAST_PORT_C>::out() & ~maskC) | value.portC;
+        if (maskD) FastPort<FAST_PORT_D>::out() = (FastPort<FAST_PORT_D>::out() & ~maskD) | value.portD;
+        SREG = oldSREG;
+    }
+
+    static inline void write(uint8_t bits) {
+        write(image(bits));
+    }
+};
+
+#endif // FAST_PIN_HPP
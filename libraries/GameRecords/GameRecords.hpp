@@ -0,0 +1,236 @@
+// GameRecords.hpp
+// EEPROM store for player profiles, a top score table per profile and a
+// ring log of recent games. Layout from the base address:
+//
+//   header    magic, table sizes, active profile
+//   profiles  PROFILES x {initials, games played, TOP_SCORES x {score, code}}
+//   log       LOG_SIZE x {sequence, profile, rounds, average response, code}
+//
+// Only the active profile and the log position are kept in RAM. A finished
+// game is written in one go by recordGame() (its profile and one log entry),
+// and put() only rewrites the bytes that changed. The log has no head pointer
+// to wear out: every entry carries a sequence number and begin() looks for
+// the newest.
+
+#ifndef GAME_RECORDS_HPP
+#define GAME_RECORDS_HPP
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <stddef.h>
+
+struct ScoreEntry {
+    uint16_t score;
+    uint16_t code;           // Challenge code the score was played on
+};
+
+struct GameLogEntry {
+    uint16_t sequence;       // 0xFFFF = never written
+    uint8_t profile;
+    uint16_t rounds;         // Rounds won
+    uint16_t averageResponse; // ms per symbol entered
+    uint16_t code;
+};
+
+template <uint8_t PROFILES, uint8_t TOP_SCORES, uint8_t LOG_SIZE>
+class GameRecords {
+public:
+    static_assert(PROFILES >= 1 && TOP_SCORES >= 1 && LOG_SIZE >= 1, "empty tables");
+
+    static const uint8_t INITIALS = 3;
+    static const uint8_t NO_RANK = 0xFF;
+    static const uint16_t NO_CODE = 0xFFFF;
+
+    struct Profile {
+        char initials[INITIALS];
+        uint16_t gamesPlayed;
+        ScoreEntry top[TOP_SCORES];  // Best first, unused entries score 0
+    };
+
+    explicit GameRecords(int eepromAddress)
+        : baseAddress(eepromAddress), activeProfile(0), logNext(0), logCount(0), nextSequence(0) {}
+
+    // False when no store (or one with other table sizes) was found and a
+    // blank one has been written
+    bool begin() {
+        Header header;
+        EEPROM.get(baseAddress, header);
+        if (header.magic != MAGIC || header.profiles != PROFILES ||
+            header.topScores != TOP_SCORES || header.logSize != LOG_SIZE) {
+            format();
+            return false;
+        }
+
+        activeProfile = header.activeProfile < PROFILES ? header.activeProfile : 0;
+        findLogHead();
+        return true;
+    }
+
+    void format() {
+        Header header = {MAGIC, PROFILES, TOP_SCORES, LOG_SIZE, 0};
+        EEPROM.put(baseAddress, header);
+
+        Profile blank;
+        for (uint8_t i = 0; i < INITIALS; i++) blank.initials[i] = ' ';
+        blank.gamesPlayed = 0;
+        for (uint8_t rank = 0; rank < TOP_SCORES; rank++) {
+            blank.top[rank].score = 0;
+            blank.top[rank].code = NO_CODE;
+        }
+        for (uint8_t profile = 0; profile < PROFILES; profile++) {
+            EEPROM.put(profileAddress(profile), blank);
+        }
+
+        for (uint8_t entry = 0; entry < LOG_SIZE; entry++) {
+            EEPROM.put(logAddress(entry), (uint16_t)EMPTY_SEQUENCE);
+        }
+
+        activeProfile = 0;
+        logNext = 0;
+        logCount = 0;
+        nextSequence = 0;
+    }
+
+    uint8_t getActiveProfile() const {
+        return activeProfile;
+    }
+
+    void setActiveProfile(uint8_t profile) {
+        if (profile >= PROFILES) return;
+        activeProfile = profile;
+        EEPROM.update(baseAddress + offsetof(Header, activeProfile), profile);
+    }
+
+    void readProfile(uint8_t profile, Profile& data) const {
+        EEPROM.get(profileAddress(profile < PROFILES ? profile : 0), data);
+    }
+
+    void setInitials(uint8_t profile, const char* initials) {
+        if (profile >= PROFILES) return;
+        for (uint8_t i = 0; i < INITIALS; i++) {
+            EEPROM.update(profileAddress(profile) + offsetof(Profile, initials) + i, initials[i]);
+        }
+    }
+
+    uint16_t getBestScore(uint8_t profile) const {
+        uint16_t score;
+        EEPROM.get(profileAddress(profile < PROFILES ? profile : 0) + offsetof(Profile, top), score);
+        return score;
+    }
+
+    // Into the profile's table if it beats an entry there; returns the rank
+    // (0 = best) or NO_RANK
+    uint8_t insertScore(uint8_t profile, uint16_t score, uint16_t code) {
+        if (profile >= PROFILES) return NO_RANK;
+        Profile data;
+        readProfile(profile, data);
+        uint8_t rank = insertScore(data, score, code);
+        if (rank != NO_RANK) {
+            EEPROM.put(profileAddress(profile), data);
+        }
+        return rank;
+    }
+
+    // A finished game of the active profile: counts it, ranks it and logs it
+    uint8_t recordGame(uint16_t rounds, uint16_t averageResponse, uint16_t code) {
+        Profile data;
+        readProfile(activeProfile, data);
+        data.gamesPlayed++;
+        uint8_t rank = insertScore(data, rounds, code);
+        EEPROM.put(profileAddress(activeProfile), data);
+
+        GameLogEntry entry;
+        entry.sequence = nextSequence;
+        entry.profile = activeProfile;
+        entry.rounds = rounds;
+        entry.averageResponse = averageResponse;
+        entry.code = code;
+        EEPROM.put(logAddress(logNext), entry);
+
+        logNext = (logNext + 1) % LOG_SIZE;
+        if (logCount < LOG_SIZE) logCount++;
+        nextSequence = (nextSequence + 1 == EMPTY_SEQUENCE) ? 0 : nextSequence + 1;
+        return rank;
+    }
+
+    uint8_t getLogCount() const {
+        return logCount;
+    }
+
+    // age 0 = the most recent game
+    bool readLog(uint8_t age, GameLogEntry& entry) const {
+        if (age >= logCount) return false;
+        EEPROM.get(logAddress((logNext + LOG_SIZE - 1 - age) % LOG_SIZE), entry);
+        return true;
+    }
+
+    static int getRegionSize() {
+        return sizeof(Header) + PROFILES * sizeof(Profile) + LOG_SIZE * sizeof(GameLogEntry);
+    }
+
+private:
+    static const uint16_t MAGIC = 0x5352;  // "SR"
+    static const uint16_t EMPTY_SEQUENCE = 0xFFFF;
+
+    struct Header {
+        uint16_t magic;
+        uint8_t profiles;
+        uint8_t topScores;
+        uint8_t logSize;
+        uint8_t activeProfile;
+    };
+
+    const int baseAddress;
+    uint8_t activeProfile;
+    uint8_t logNext;         // Slot the next game goes to
+    uint8_t logCount;
+    uint16_t nextSequence;
+
+    int profileAddress(uint8_t profile) const {
+        return baseAddress + sizeof(Header) + profile * sizeof(Profile);
+    }
+
+    int logAddress(uint8_t slot) const {
+        return baseAddress + sizeof(Header) + PROFILES * sizeof(Profile) + slot * sizeof(GameLogEntry);
+    }
+
+    static uint8_t insertScore(Profile& data, uint16_t score, uint16_t code) {
+        uint8_t rank = 0;
+        while (rank < TOP_SCORES && data.top[rank].score >= score) rank++;
+        if (rank >= TOP_SCORES || score == 0) return NO_RANK;
+
+        for (uint8_t i = TOP_SCORES - 1; i > rank; i--) {
+            data.top[i] = data.top[i - 1];
+        }
+        data.top[rank].score = score;
+        data.top[rank].code = code;
+        return rank;
+    }
+
+    // The newest entry is the one with the highest sequence (wrap-safe)
+    void findLogHead() {
+        logCount = 0;
+        logNext = 0;
+        nextSequence = 0;
+
+        bool found = false;
+        uint16_t newest = 0;
+        for (uint8_t slot = 0; slot < LOG_SIZE; slot++) {
+            uint16_t sequence;
+            EEPROM.get(logAddress(slot), sequence);
+            if (sequence == EMPTY_SEQUENCE) continue;
+
+            logCount++;
+            if (!found || (int16_t)(sequence - newest) > 0) {
+                found = true;
+                newest = sequence;
+                logNext = (slot + 1) % LOG_SIZE;
+            }
+        }
+        if (found) {
+            nextSequence = (newest + 1 == EMPTY_SEQUENCE) ? 0 : newest + 1;
+        }
+    }
+};
+
+#endif // GAME_RECORDS_HPP
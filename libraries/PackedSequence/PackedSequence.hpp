@@ -0,0 +1,76 @@
+// PackedSequence.hpp
+// Fixed-capacity sequence of small codes, BITS bits each, packed back to back
+// into a byte buffer. A 512-step sequence of 5-bit symbols takes 320 bytes of
+// SRAM instead of 512.
+//
+// Codes may straddle a byte boundary; get() and append() touch at most two
+// bytes, so both are constant time.
+
+#ifndef PACKED_SEQUENCE_HPP
+#define PACKED_SEQUENCE_HPP
+
+#include <Arduino.h>
+
+template <uint16_t CAPACITY, uint8_t BITS>
+class PackedSequence {
+public:
+    static_assert(BITS >= 1 && BITS <= 8, "codes must be 1 to 8 bits wide");
+    static_assert((unsigned long)CAPACITY * BITS <= 0xFFFF, "bit index must fit 16 bits");
+
+    static const uint16_t capacity = CAPACITY;
+    static const uint8_t codeMask = (uint8_t)((1 << BITS) - 1);
+
+    PackedSequence() : count(0) {}
+
+    void clear() {
+        count = 0;
+    }
+
+    uint16_t length() const {
+        return count;
+    }
+
+    bool isFull() const {
+        return count >= CAPACITY;
+    }
+
+    // False (and nothing stored) once the buffer is full
+    bool append(uint8_t code) {
+        if (isFull()) return false;
+
+        uint16_t bit = count * BITS;
+        uint16_t byteIndex = bit >> 3;
+        uint8_t shift = bit & 7;
+        uint16_t window = (uint16_t)(code & codeMask) << shift;
+        uint16_t clearMask = ~((uint16_t)codeMask << shift);
+
+        data[byteIndex] = (data[byteIndex] & (uint8_t)clearMask) | (uint8_t)window;
+        if (shift + BITS > 8) {
+            data[byteIndex + 1] = (data[byteIndex + 1] & (uint8_t)(clearMask >> 8)) |
+                                  (uint8_t)(window >> 8);
+        }
+
+        count++;
+        return true;
+    }
+
+    uint8_t get(uint16_t index) const {
+        if (index >= count) return 0;
+
+        uint16_t bit = index * BITS;
+        uint16_t byteIndex = bit >> 3;
+        uint8_t shift = bit & 7;
+
+        uint16_t window = data[byteIndex];
+        if (shift + BITS > 8) {
+            window |= (uint16_t)data[byteIndex + 1] << 8;
+        }
+        return (uint8_t)(window >> shift) & codeMask;
+    }
+
+private:
+    uint8_t data[((unsigned long)CAPACITY * BITS + 7) / 8];
+    uint16_t count;
+};
+
+#endif // PACKED_SEQUENCE_HPP
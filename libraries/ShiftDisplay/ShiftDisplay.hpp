@@ -0,0 +1,78 @@
+// ShiftDisplay.hpp
+// Multiplexed 7-segment display behind a chain of 74HC595 shift registers on
+// hardware SPI (MOSI -> DS, SCK -> SHCP, LATCH_PIN -> STCP).
+//
+// The segment register sits first in the chain, followed by SELECT_REGISTERS
+// digit-select registers (8 digits each, active low for common cathode):
+//
+//   MOSI -> [segments] -> [select 0: digits 0-7] -> [select 1: digits 8-15]
+//
+// show() sends the whole chain as one buffered SPI.transfer(buffer, n) at the
+// fastest SPI clock and latches it, so each refresh costs one burst of
+// 1 + SELECT_REGISTERS bytes whatever the display width. With
+// SELECT_REGISTERS = 0 only the segment byte is sent and digit selection is
+// left to the caller (e.g. GPIOs through FastPinGroup).
+
+#ifndef SHIFT_DISPLAY_HPP
+#define SHIFT_DISPLAY_HPP
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <FastPin.hpp>
+
+// Digit mask wide enough for the display (bit i = digit i)
+template <bool WIDE> struct ShiftDisplayMask { typedef uint8_t type; };
+template <> struct ShiftDisplayMask<true> { typedef uint16_t type; };
+
+template <uint8_t DIGITS, uint8_t LATCH_PIN, uint8_t SELECT_REGISTERS = (DIGITS + 7) / 8,
+          bool SELECT_ACTIVE_LOW = true>
+class ShiftDisplay {
+public:
+    static_assert(DIGITS >= 1 && DIGITS <= 16, "ShiftDisplay drives 1 to 16 digits");
+    static_assert(SELECT_REGISTERS == 0 || SELECT_REGISTERS * 8 >= DIGITS,
+                  "not enough select registers for the display width");
+
+    typedef typename ShiftDisplayMask<(DIGITS > 8)>::type Mask;
+
+    static const uint8_t digits = DIGITS;
+    static const uint8_t chainLength = 1 + SELECT_REGISTERS;
+    static const bool selectsDigits = SELECT_REGISTERS > 0;
+    static const uint8_t noDigit = 0xFF;
+
+    static void begin() {
+        FastPin<LATCH_PIN>::output();
+        FastPin<LATCH_PIN>::high();
+        SPI.begin();
+        blank();
+    }
+
+    // Light one digit with the given segments (all others off)
+    static void show(uint8_t digit, uint8_t segments) {
+        uint8_t buffer[chainLength];
+
+        // First byte out ends up in the farthest register
+        for (uint8_t i = 0; i < SELECT_REGISTERS; i++) {
+            uint8_t reg = SELECT_REGISTERS - 1 - i;
+            uint8_t active = (digit / 8 == reg) ? (uint8_t)(1 << (digit % 8)) : 0;
+            buffer[i] = SELECT_ACTIVE_LOW ? (uint8_t)~active : active;
+        }
+        buffer[SELECT_REGISTERS] = segments;
+
+        send(buffer);
+    }
+
+    static void blank() {
+        show(noDigit, 0);
+    }
+
+private:
+    static inline void send(uint8_t* buffer) {
+        SPI.beginTransaction(SPISettings(F_CPU / 2, MSBFIRST, SPI_MODE0));
+        FastPin<LATCH_PIN>::low();
+        SPI.transfer(buffer, chainLength);
+        FastPin<LATCH_PIN>::high();  // Rising edge copies the chain to the outputs
+        SPI.endTransaction();
+    }
+};
+
+#endif // SHIFT_DISPLAY_HPP
@@ -0,0 +1,222 @@
+// StateMachine.hpp
+// Table-driven finite state machine. Both tables live in flash:
+//
+//   StateHandlers[state]  enter / exit / update hooks and a default timeout
+//   StateTransition[]     (state, event) -> (next state, action)
+//
+// dispatch() scans the transition table once for the first row matching the
+// current state (or ANY_STATE) and the event, then runs
+// exit(old) -> action -> enter(new). A row whose next state is STAY is an
+// internal transition: only its action runs and the state timer keeps going.
+//
+// A state's timeout (from its table entry, or re-armed with setTimeout() by
+// an enter hook or action) fires the timeout event once through the same
+// table. Hooks and actions must not call dispatch() themselves; they post()
+// follow-up events, which run as soon as the current one is finished.
+//
+// Nothing is allocated: the engine keeps the current state, its timers, a
+// few posted events and per-state dwell statistics (entries, total and
+// longest time spent in each state).
+
+#ifndef STATE_MACHINE_HPP
+#define STATE_MACHINE_HPP
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+typedef void (*StateAction)();
+
+struct StateHandlers {
+    StateAction enter;       // May be null (as may the other hooks)
+    StateAction exit;
+    StateAction update;      // Every update() call while in the state
+    uint16_t timeout;        // ms after entering until the timeout event, 0 = none
+};
+
+struct StateTransition {
+    uint8_t state;           // Or ANY_STATE
+    uint8_t event;
+    uint8_t nextState;       // Or STAY
+    StateAction action;      // May be null
+};
+
+struct StateDwell {
+    uint16_t entries;
+    unsigned long totalTime; // ms
+    unsigned long longestTime;
+};
+
+template <uint8_t STATE_COUNT>
+class StateMachine {
+public:
+    static_assert(STATE_COUNT >= 1 && STATE_COUNT < 0xFE, "state ids 0xFE and 0xFF are reserved");
+
+    static const uint8_t ANY_STATE = 0xFF;
+    static const uint8_t STAY = 0xFE;
+
+    // Both tables must be in PROGMEM
+    StateMachine(const StateHandlers* stateTable, const StateTransition* transitionTable,
+                 uint8_t transitionCount, uint8_t timeoutEvent)
+        : states(stateTable), transitions(transitionTable),
+          transitionCount(transitionCount), timeoutEvent(timeoutEvent),
+          currentState(0), enteredAt(0), timeoutStart(0), timeoutLength(0),
+          timeoutArmed(false), postedCount(0) {
+        resetDwell();
+    }
+
+    void begin(uint8_t initialState) {
+        enterState(initialState);
+        runPosted();
+    }
+
+    // True when a transition matched (unmatched events are simply dropped)
+    bool dispatch(uint8_t event) {
+        bool handled = handle(event);
+        runPosted();
+        return handled;
+    }
+
+    // Queue an event from inside a hook or action
+    void post(uint8_t event) {
+        if (postedCount < postedSize) {
+            posted[postedCount++] = event;
+        }
+    }
+
+    // Call every loop() pass: fires a due timeout, then the state's update hook
+    void update() {
+        if (timeoutArmed && millis() - timeoutStart >= timeoutLength) {
+            timeoutArmed = false;
+            handle(timeoutEvent);
+        }
+
+        StateHandlers handlers;
+        readHandlers(currentState, handlers);
+        if (handlers.update != nullptr) {
+            handlers.update();
+        }
+        runPosted();
+    }
+
+    // (Re)arm the timeout, counted from now
+    void setTimeout(unsigned long length) {
+        timeoutStart = millis();
+        timeoutLength = length;
+        timeoutArmed = true;
+    }
+
+    void clearTimeout() {
+        timeoutArmed = false;
+    }
+
+    uint8_t getState() const {
+        return currentState;
+    }
+
+    unsigned long getTimeInState() const {
+        return millis() - enteredAt;
+    }
+
+    // Times cover completed visits only (the current one counts once it is left)
+    const StateDwell& getDwell(uint8_t state) const {
+        return dwell[state < STATE_COUNT ? state : 0];
+    }
+
+    void resetDwell() {
+        for (uint8_t state = 0; state < STATE_COUNT; state++) {
+            dwell[state].entries = 0;
+            dwell[state].totalTime = 0;
+            dwell[state].longestTime = 0;
+        }
+    }
+
+private:
+    static const uint8_t postedSize = 4;
+
+    const StateHandlers* const states;
+    const StateTransition* const transitions;
+    const uint8_t transitionCount;
+    const uint8_t timeoutEvent;
+
+    uint8_t currentState;
+    unsigned long enteredAt;
+    unsigned long timeoutStart;
+    unsigned long timeoutLength;
+    bool timeoutArmed;
+
+    uint8_t posted[postedSize];
+    uint8_t postedCount;
+
+    StateDwell dwell[STATE_COUNT];
+
+    void readHandlers(uint8_t state, StateHandlers& handlers) const {
+        memcpy_P(&handlers, &states[state], sizeof(StateHandlers));
+    }
+
+    bool handle(uint8_t event) {
+        StateTransition row;
+        for (uint8_t i = 0; i < transitionCount; i++) {
+            memcpy_P(&row, &transitions[i], sizeof(StateTransition));
+            if (row.event == event && (row.state == currentState || row.state == ANY_STATE)) {
+                take(row);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void take(const StateTransition& row) {
+        if (row.nextState == STAY) {
+            if (row.action != nullptr) row.action();
+            return;
+        }
+
+        StateHandlers handlers;
+        readHandlers(currentState, handlers);
+        if (handlers.exit != nullptr) {
+            handlers.exit();
+        }
+        leaveState();
+
+        if (row.action != nullptr) {
+            row.action();
+        }
+        enterState(row.nextState);
+    }
+
+    void leaveState() {
+        unsigned long elapsed = millis() - enteredAt;
+        StateDwell& stats = dwell[currentState];
+        stats.totalTime += elapsed;
+        if (elapsed > stats.longestTime) {
+            stats.longestTime = elapsed;
+        }
+    }
+
+    void enterState(uint8_t state) {
+        currentState = state;
+        enteredAt = millis();
+        dwell[state].entries++;
+
+        StateHandlers handlers;
+        readHandlers(state, handlers);
+        timeoutArmed = false;
+        if (handlers.timeout > 0) {
+            setTimeout(handlers.timeout);
+        }
+        if (handlers.enter != nullptr) {
+            handlers.enter();
+        }
+    }
+
+    // Posted events run in order; ones posted meanwhile join the end
+    void runPosted() {
+        uint8_t next = 0;
+        while (next < postedCount) {
+            handle(posted[next++]);
+        }
+        postedCount = 0;
+    }
+};
+
+#endif // STATE_MACHINE_HPP
@@ -0,0 +1,183 @@
+// ToneQueue.hpp
+// Non-blocking buzzer cues on Timer2. A cue is a short list of notes kept in
+// flash. play() starts or queues it, and the Timer2 compare interrupt
+// toggles the pin and steps through the notes, so loop() never waits on a
+// sound and back-to-back cues play one after the other instead of cutting
+// each other off.
+//
+// Notes are turned into timer settings at compile time with toneNote(), so
+// the interrupt only counts down and, between notes, loads three values.
+//
+// Each cue has a priority and a queue limit. A cue with a higher priority
+// than the one playing cuts it off and clears the queue (a jingle over a
+// tick). Otherwise it waits its turn, but only while fewer than queueLimit
+// cues are already waiting, so a held joystick can't pile up ticks.
+//
+// Takes over Timer2 (like tone(), which must not be used alongside it); the
+// sketch forwards ISR(TIMER2_COMPA_vect) to tick().
+
+#ifndef TONE_QUEUE_HPP
+#define TONE_QUEUE_HPP
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include <FastPin.hpp>
+
+struct ToneStep {
+    uint8_t compare;         // OCR2A
+    uint8_t clock;           // CS2x bits, plus TONE_REST
+    uint16_t ticks;          // Compare matches until the next note
+};
+
+const uint8_t TONE_REST = 0x80;  // Count, but leave the pin low
+
+struct ToneCue {
+    const ToneStep* steps;   // In PROGMEM
+    uint8_t stepCount;
+    uint8_t priority;        // Higher cuts off lower
+    uint8_t queueLimit;      // Only queued while fewer than this are waiting
+};
+
+// Compile-time note timing: the smallest Timer2 prescaler that fits half a
+// period in 8 bits, and how many half periods make up the duration
+constexpr uint16_t tonePrescaler(uint8_t index) {
+    return index == 0 ? 1 : index == 1 ? 8 : index == 2 ? 32 : index == 3 ? 64 :
+           index == 4 ? 128 : index == 5 ? 256 : 1024;
+}
+
+constexpr uint8_t tonePrescalerIndex(uint32_t halfPeriod, uint8_t index = 0) {
+    return (index >= 6 || halfPeriod / tonePrescaler(index) <= 256) ?
+               index : tonePrescalerIndex(halfPeriod, index + 1);
+}
+
+constexpr ToneStep toneStep(uint32_t halfPeriod, uint8_t index, uint32_t ticks) {
+    return ToneStep{(uint8_t)(halfPeriod / tonePrescaler(index) - 1), (uint8_t)(index + 1),
+                    (uint16_t)(ticks > 0 ? (ticks < 0xFFFF ? ticks : 0xFFFF) : 1)};
+}
+
+// frequency in Hz (0 = rest), duration in ms
+constexpr ToneStep toneNote(uint16_t frequency, uint16_t duration) {
+    return frequency == 0 ?
+               // Rests count milliseconds at clk/64
+               ToneStep{(uint8_t)(F_CPU / 64 / 1000 - 1), (uint8_t)(4 | TONE_REST), duration} :
+               toneStep(F_CPU / 2 / frequency, tonePrescalerIndex(F_CPU / 2 / frequency),
+                        2UL * frequency * duration / 1000);
+}
+
+template <uint8_t PIN, uint8_t QUEUE_SIZE>
+class ToneQueue {
+public:
+    ToneQueue() : playing(false), toggling(false), stepIndex(0), remaining(0),
+                  queueHead(0), queuedCount(0) {
+        current.steps = nullptr;
+        current.stepCount = 0;
+        current.priority = 0;
+        current.queueLimit = 0;
+    }
+
+    void begin() {
+        FastPin<PIN>::output();
+        FastPin<PIN>::low();
+        noInterrupts();
+        stop();
+        interrupts();
+    }
+
+    // cue must be in PROGMEM; false when it was dropped
+    bool play(const ToneCue& cue) {
+        ToneCue incoming;
+        memcpy_P(&incoming, &cue, sizeof(ToneCue));
+        if (incoming.stepCount == 0) return false;
+
+        bool accepted = true;
+        noInterrupts();
+        if (!playing || incoming.priority > current.priority) {
+            queuedCount = 0;
+            start(incoming);
+        } else if (queuedCount < QUEUE_SIZE && queuedCount < incoming.queueLimit) {
+            queue[(queueHead + queuedCount) % QUEUE_SIZE] = &cue;
+            queuedCount++;
+        } else {
+            accepted = false;
+        }
+        interrupts();
+        return accepted;
+    }
+
+    void silence() {
+        noInterrupts();
+        queuedCount = 0;
+        stop();
+        interrupts();
+    }
+
+    bool isPlaying() const {
+        return playing;
+    }
+
+    // From ISR(TIMER2_COMPA_vect)
+    void tick() {
+        if (toggling) {
+            FastPin<PIN>::toggle();
+        }
+        if (--remaining != 0) {
+            return;
+        }
+
+        if (++stepIndex < current.stepCount) {
+            loadStep();
+        } else if (queuedCount > 0) {
+            ToneCue next;
+            memcpy_P(&next, queue[queueHead], sizeof(ToneCue));
+            queueHead = (queueHead + 1) % QUEUE_SIZE;
+            queuedCount--;
+            start(next);
+        } else {
+            stop();
+        }
+    }
+
+private:
+    volatile bool playing;
+    bool toggling;
+    ToneCue current;
+    uint8_t stepIndex;
+    uint16_t remaining;
+
+    const ToneCue* queue[QUEUE_SIZE];
+    uint8_t queueHead;
+    uint8_t queuedCount;
+
+    // The rest run with interrupts off (or inside the ISR)
+    void start(const ToneCue& cue) {
+        current = cue;
+        stepIndex = 0;
+        playing = true;
+        loadStep();
+    }
+
+    void loadStep() {
+        ToneStep step;
+        memcpy_P(&step, &current.steps[stepIndex], sizeof(ToneStep));
+        FastPin<PIN>::low();
+        toggling = (step.clock & TONE_REST) == 0;
+        remaining = step.ticks;
+
+        TCCR2A = _BV(WGM21);  // CTC on OCR2A
+        TCCR2B = step.clock & 0x07;
+        OCR2A = step.compare;
+        TCNT2 = 0;
+        TIFR2 = _BV(OCF2A);
+        TIMSK2 = _BV(OCIE2A);
+    }
+
+    void stop() {
+        TIMSK2 = 0;
+        TCCR2B = 0;
+        FastPin<PIN>::low();
+        playing = false;
+        toggling = false;
+    }
+};
+
+#endif // TONE_QUEUE_HPP
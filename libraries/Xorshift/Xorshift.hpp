@@ -0,0 +1,56 @@
+// Xorshift.hpp
+// Marsaglia xorshift32 generator (shift triple 13/17/5, period 2^32 - 1).
+// Each number costs three shifts and XORs, where random() needs a 32-bit
+// multiply and divide. The whole state is one uint32_t, so a seed replays
+// the exact same sequence on any board (or on the host).
+
+#ifndef XORSHIFT_HPP
+#define XORSHIFT_HPP
+
+#include <Arduino.h>
+
+class Xorshift32 {
+public:
+    explicit Xorshift32(uint32_t seed = 1) {
+        setSeed(seed);
+    }
+
+    // Zero is the one state xorshift never leaves, so it is swapped out
+    void setSeed(uint32_t seed) {
+        state = (seed != 0) ? seed : 0x9E3779B9UL;
+    }
+
+    uint32_t getState() const {
+        return state;
+    }
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Uniform in [0, bound): the top 16 bits scaled by a 16x16 multiply, no
+    // division (bias is below bound / 65536)
+    uint16_t nextBelow(uint16_t bound) {
+        uint16_t high = (uint16_t)(next() >> 16);
+        return (uint16_t)(((uint32_t)high * bound) >> 16);
+    }
+
+    // Spreads a small code (e.g. 0-9999) over the whole state, so neighbouring
+    // codes start unrelated sequences (MurmurHash3 finalizer, a bijection)
+    static uint32_t seedFromCode(uint32_t code) {
+        code ^= code >> 16;
+        code *= 0x85EBCA6BUL;
+        code ^= code >> 13;
+        code *= 0xC2B2AE35UL;
+        code ^= code >> 16;
+        return code;
+    }
+
+private:
+    uint32_t state;
+};
+
+#endif // XORSHIFT_HPP